@@ -0,0 +1,251 @@
+#pragma once
+
+#include <algorithm>
+#include <cstdint>
+#include <iterator>
+#include <ostream>
+#include <string>
+#include <thread>
+#include <type_traits>
+#include <vector>
+#include "Lab4_CountingSort.h"
+#include "Lab4_InsertionSort.h"
+#include "Lab4_IntroSort.h"
+#include "Lab4_MergeSort.h"
+#include "Lab4_Parallel.h"
+#include "Lab4_RadixSort.h"
+#include "Lab4_SortingNetwork.h"
+#include "Lab4_Tuning.h"
+
+// Inputs up to this size go to a sorting network or (binary) insertion sort
+const int tinySortLimit = 64;
+// Keys sampled to estimate how many distinct keys the input has
+const int distinctSampleSize = 256;
+// Inputs whose average ascending run is at least this long go to Natural Merge Sort
+const int minAverageRun = 32;
+// Inputs at least this large are sorted in parallel when the machine has several cores
+const int parallelSortLimit = 1 << 20;
+// 32-bit integer inputs at least this large use LSD Radix Sort when Counting Sort does not
+// fit; wider keys scale the limit by their size
+const int radixSortLimit = 1 << 10;
+
+// What the dispatcher measured about its input
+struct InputStats {
+    size_t size = 0;
+    size_t elementSize = 0;      // bytes per key, which sets the radix pass count
+    long descents = 0;           // i with arr[i] < arr[i - 1]; runs = descents + 1
+    int sampleSize = 0;          // keys in the distinct-key sample
+    int sampleDistinct = 0;      // distinct keys among them
+    bool hasRange = false;       // whether keyRange is known (integer keys)
+    unsigned long long keyRange = 0;  // max - min for integer keys
+};
+
+// Engines the adaptive sort dispatches to
+enum class SortEngine {
+    None,             // nothing to do
+    SortingNetwork,   // smallSort: SIMD network for int32/float/double
+    Insertion,
+    BinaryInsertion,
+    Reverse,          // strictly descending input
+    NaturalMerge,
+    Counting,
+    LsdRadix,
+    ThreeWayIntro,
+    ParallelQuick,
+    Intro             // Intro Sort with the Simd (or Block) partition
+};
+
+// Human-readable name of an engine
+inline std::string sortEngineName(SortEngine engine) {
+    switch (engine) {
+        case SortEngine::None: return "none";
+        case SortEngine::SortingNetwork: return "sorting network";
+        case SortEngine::Insertion: return "insertion sort";
+        case SortEngine::BinaryInsertion: return "binary insertion sort";
+        case SortEngine::Reverse: return "reverse";
+        case SortEngine::NaturalMerge: return "natural merge sort";
+        case SortEngine::Counting: return "counting sort";
+        case SortEngine::LsdRadix: return "lsd radix sort";
+        case SortEngine::ThreeWayIntro: return "three-way intro sort";
+        case SortEngine::ParallelQuick: return "parallel quick sort";
+        case SortEngine::Intro: return "intro sort";
+    }
+    return "unknown";
+}
+
+// The engine the dispatcher picked and why
+struct SortChoice {
+    SortEngine engine = SortEngine::None;
+    std::string reason;
+};
+
+// Where adaptiveSort() logs its choices; nothing is logged while this is null, so the
+// benchmarks' repeated runs stay quiet and print one choice each through explainSort()
+inline std::ostream*& sortLog() {
+    static std::ostream* log = nullptr;
+    return log;
+}
+
+// Log every later adaptiveSort() choice to `out`, or stop logging with nullptr
+inline void setSortLog(std::ostream* out) {
+    sortLog() = out;
+}
+
+// Print one choice and the statistics behind it
+inline void logSortChoice(std::ostream& out, const InputStats& stats, const SortChoice& choice) {
+    out << "sort: " << sortEngineName(choice.engine) << " (" << choice.reason << "; n=" << stats.size
+        << ", element " << stats.elementSize << " bytes, runs " << stats.descents + 1
+        << ", distinct " << stats.sampleDistinct << "/" << stats.sampleSize;
+    if (stats.hasRange) out << ", key range " << stats.keyRange + 1;
+    out << ")" << std::endl;
+}
+
+// Integer key types the counting and radix paths handle
+template <typename T>
+constexpr bool isRadixInteger = std::is_same<T, int32_t>::value || std::is_same<T, uint32_t>::value ||
+                                std::is_same<T, int64_t>::value || std::is_same<T, uint64_t>::value;
+
+// Whether [It, It) ordered by `Compare` may go to the counting and radix paths
+template <typename It, typename Compare>
+constexpr bool radixSortable = isRadixInteger<std::iter_value_t<It>> && plainOrder<Compare, std::iter_value_t<It>>;
+
+// Measure the statistics the dispatcher decides on: one branchless pass for the
+// descents, a min/max pass for integer keys and a sorted sample for distinct keys.
+// The sample holds iterators, so no element is copied.
+template <typename It, typename Compare>
+InputStats measureInput(It first, It last, Compare comp) {
+    InputStats stats;
+    size_t n = last - first;
+    stats.size = n;
+    stats.elementSize = sizeof(std::iter_value_t<It>);
+    for (size_t i = 1; i < n; ++i) {
+        stats.descents += comp(first[i], first[i - 1]);
+    }
+    if constexpr (radixSortable<It, Compare>) {
+        if (n > 0) {
+            auto [min, max] = keyRange(first, last);
+            stats.hasRange = true;
+            stats.keyRange = keySpan(min, max);
+        }
+    }
+    stats.sampleSize = static_cast<int>(std::min<size_t>(n, distinctSampleSize));
+    if (stats.sampleSize > 0) {
+        std::vector<It> sample;
+        sample.reserve(stats.sampleSize);
+        for (int i = 0; i < stats.sampleSize; ++i) {
+            sample.push_back(first + i * n / stats.sampleSize);
+        }
+        std::sort(sample.begin(), sample.end(), [&comp](It a, It b) { return comp(*a, *b); });
+        auto equal = [&comp](It a, It b) { return !comp(*a, *b); };
+        stats.sampleDistinct = static_cast<int>(std::unique(sample.begin(), sample.end(), equal) - sample.begin());
+    }
+    return stats;
+}
+
+// Statistics of arr in ascending order
+template <typename T>
+InputStats measureInput(const std::vector<T>& arr) {
+    return measureInput(arr.begin(), arr.end(), std::less<>());
+}
+
+// Pick an engine for [It, It) ordered by `Compare` with these statistics;
+// `threads` is the core count
+template <typename It, typename Compare>
+SortChoice chooseSort(const InputStats& stats, int threads) {
+    using T = std::iter_value_t<It>;
+    long n = static_cast<long>(stats.size);
+    if (n < 2) return {SortEngine::None, "fewer than two keys"};
+    if (stats.descents == 0) return {SortEngine::None, "already sorted"};
+    if (n <= tinySortLimit) {
+        if (vectorizable<It, Compare>) return {SortEngine::SortingNetwork, "tiny input"};
+        if (std::is_arithmetic<T>::value) return {SortEngine::Insertion, "tiny input"};
+        return {SortEngine::BinaryInsertion, "tiny input with costly comparisons"};
+    }
+    if (stats.descents == n - 1) return {SortEngine::Reverse, "strictly descending"};
+    if (stats.descents * minAverageRun < n) return {SortEngine::NaturalMerge, "long ascending runs"};
+    if (stats.hasRange) {
+        if (stats.keyRange < static_cast<unsigned long long>(maxCountingRange) &&
+            preferCountingSort(static_cast<long long>(stats.keyRange) + 1, n)) {
+            return {SortEngine::Counting, "integer keys in a small range"};
+        }
+        // One 8-bit radix pass per key byte, so 64-bit keys need twice the input to pay off
+        long radixLimit = radixSortLimit * static_cast<long>(stats.elementSize / sizeof(int32_t));
+        if (n >= radixLimit) return {SortEngine::LsdRadix, "integer keys"};
+    }
+    if (stats.sampleDistinct * 4 <= stats.sampleSize) return {SortEngine::ThreeWayIntro, "many duplicate keys"};
+    if (n >= parallelSortLimit && threads > 1) return {SortEngine::ParallelQuick, "very large input"};
+    return {SortEngine::Intro, "general input"};
+}
+
+// Adaptive sort of [first, last) by `comp`: measure the input, pick the best engine for it
+// and run that engine. The counting, radix and vector engines are only considered for
+// plain ascending order. Returns the choice, which is also written to sortLog() when one is set.
+template <typename It, typename Compare>
+SortChoice adaptiveSort(It first, It last, Compare comp) {
+    using T = std::iter_value_t<It>;
+    int threads = static_cast<int>(std::max(1u, std::thread::hardware_concurrency()));
+    InputStats stats = measureInput(first, last, comp);
+    SortChoice choice = chooseSort<It, Compare>(stats, threads);
+    if (sortLog()) logSortChoice(*sortLog(), stats, choice);
+
+    switch (choice.engine) {
+        case SortEngine::None:
+            break;
+        case SortEngine::SortingNetwork:
+            smallSort(first, last, comp);
+            break;
+        case SortEngine::Insertion:
+            insertionSort(first, last, comp);
+            break;
+        case SortEngine::BinaryInsertion:
+            binaryInsertionSort(first, last, comp);
+            break;
+        case SortEngine::Reverse:
+            std::reverse(first, last);
+            break;
+        case SortEngine::NaturalMerge:
+            naturalMergeSort(first, last, comp);
+            break;
+        case SortEngine::Counting:
+            if constexpr (radixSortable<It, Compare>) {
+                auto [min, max] = keyRange(first, last);
+                countingSort(first, last, min, max);
+            }
+            break;
+        case SortEngine::LsdRadix:
+            if constexpr (radixSortable<It, Compare>) {
+                std::vector<T> buffer;
+                lsdRadixSort(first, last, buffer);
+            }
+            break;
+        case SortEngine::ThreeWayIntro:
+            introSort(first, last, comp, tunedThreshold<T>("quick-hybrid"), PartitionScheme::ThreeWay);
+            break;
+        case SortEngine::ParallelQuick: {
+            ThreadPool pool(threads);
+            parallelQuickSort(first, last, pool, comp);
+            break;
+        }
+        case SortEngine::Intro:
+            introSort(first, last, comp, tunedThreshold<T>("quick-hybrid"),
+                      vectorizable<It, Compare> ? PartitionScheme::Simd : PartitionScheme::Block);
+            break;
+    }
+    return choice;
+}
+
+// Adaptive sort of arr in ascending order
+template <typename T>
+SortChoice adaptiveSort(std::vector<T>& arr) {
+    return adaptiveSort(arr.begin(), arr.end(), std::less<>());
+}
+
+// Print the engine adaptiveSort() would pick for `arr` without sorting it
+template <typename T>
+SortChoice explainSort(const std::vector<T>& arr, std::ostream& out) {
+    int threads = static_cast<int>(std::max(1u, std::thread::hardware_concurrency()));
+    InputStats stats = measureInput(arr);
+    SortChoice choice = chooseSort<typename std::vector<T>::const_iterator, std::less<>>(stats, threads);
+    logSortChoice(out, stats, choice);
+    return choice;
+}
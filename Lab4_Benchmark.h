@@ -0,0 +1,326 @@
+#pragma once
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cmath>
+#include <cstdlib>
+#include <fstream>
+#include <iostream>
+#include <memory>
+#include <string>
+#include <thread>
+#include <vector>
+
+#ifdef __linux__
+#include <cstring>
+#include <linux/perf_event.h>
+#include <sys/ioctl.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+#endif
+
+// Settings shared by every benchmark run of an exercise
+struct BenchmarkConfig {
+    int warmup = 2;        // untimed runs before measuring
+    int repetitions = 10;  // timed runs used for the statistics
+    std::string csvPath;   // write all results as CSV when not empty
+    std::string jsonPath;  // write all results as JSON when not empty
+    int threads = static_cast<int>(std::max(1u, std::thread::hardware_concurrency())); // for parallel sorts
+    bool branchMisses = false;  // count branch mispredictions where hardware counters are available
+    bool calibrate = false;     // sweep the hybrid sorts' cutoffs and save them to profilePath
+    std::string profilePath = "lab4_thresholds.txt";  // threshold profile read by the hybrid sorts
+    int memoryMB = 64;          // memory budget of the external sort
+    int externalMB = 0;         // size of the file the external sort benchmark sorts, 0 to skip it
+    std::string tempDir;        // run files of the external sort; empty for the system temp directory
+    std::string inputPath;      // file mode: sort this binary file instead of running the benchmarks
+    std::string outputPath;     // file mode: write the sorted file here; empty sorts the input in place
+    std::string keyType = "int32";  // file mode key: int32, int64 or double
+    int recordSize = 0;         // file mode: bytes per record, 0 when the file holds bare keys
+    int keyOffset = 0;          // file mode: byte offset of the key inside each record
+    std::string sortEngine;     // file mode engine; empty for the exercise's own choice
+};
+
+// Statistics of one benchmark, all times in seconds
+struct BenchmarkResult {
+    std::string name;
+    std::string group;     // free-form label, e.g. the element type
+    size_t size = 0;
+    int repetitions = 0;
+    double min = 0.0;
+    double median = 0.0;
+    double p95 = 0.0;
+    double mean = 0.0;
+    double stddev = 0.0;
+    double branchMisses = -1.0;  // mean mispredicted branches per run, -1 when not counted
+};
+
+// Parse --warmup N, --reps N, --csv FILE, --json FILE, --threads N, --branch-misses,
+// --calibrate, --profile FILE, --memory MB, --external-mb MB, --temp-dir DIR and the file
+// mode options --input FILE, --output FILE, --key TYPE, --record-size N, --key-offset N and
+// --sort ENGINE from the command line
+inline BenchmarkConfig parseBenchmarkArgs(int argc, char* argv[]) {
+    BenchmarkConfig config;
+    for (int i = 1; i < argc; ++i) {
+        std::string arg = argv[i];
+        bool hasValue = i + 1 < argc;
+        if (arg == "--warmup" && hasValue) {
+            config.warmup = std::max(0, std::atoi(argv[++i]));
+        } else if (arg == "--reps" && hasValue) {
+            config.repetitions = std::max(1, std::atoi(argv[++i]));
+        } else if (arg == "--csv" && hasValue) {
+            config.csvPath = argv[++i];
+        } else if (arg == "--json" && hasValue) {
+            config.jsonPath = argv[++i];
+        } else if (arg == "--threads" && hasValue) {
+            config.threads = std::max(1, std::atoi(argv[++i]));
+        } else if (arg == "--branch-misses") {
+            config.branchMisses = true;
+        } else if (arg == "--calibrate") {
+            config.calibrate = true;
+        } else if (arg == "--profile" && hasValue) {
+            config.profilePath = argv[++i];
+        } else if (arg == "--memory" && hasValue) {
+            config.memoryMB = std::max(1, std::atoi(argv[++i]));
+        } else if (arg == "--external-mb" && hasValue) {
+            config.externalMB = std::max(0, std::atoi(argv[++i]));
+        } else if (arg == "--temp-dir" && hasValue) {
+            config.tempDir = argv[++i];
+        } else if (arg == "--input" && hasValue) {
+            config.inputPath = argv[++i];
+        } else if (arg == "--output" && hasValue) {
+            config.outputPath = argv[++i];
+        } else if (arg == "--key" && hasValue) {
+            config.keyType = argv[++i];
+        } else if (arg == "--record-size" && hasValue) {
+            config.recordSize = std::max(0, std::atoi(argv[++i]));
+        } else if (arg == "--key-offset" && hasValue) {
+            config.keyOffset = std::max(0, std::atoi(argv[++i]));
+        } else if (arg == "--sort" && hasValue) {
+            config.sortEngine = argv[++i];
+        } else {
+            std::cerr << "Usage: " << argv[0]
+                      << " [--warmup N] [--reps N] [--csv FILE] [--json FILE] [--threads N] [--branch-misses]"
+                      << " [--calibrate] [--profile FILE] [--memory MB] [--external-mb MB] [--temp-dir DIR]"
+                      << " [--input FILE [--output FILE] [--key int32|int64|double] [--record-size N]"
+                      << " [--key-offset N] [--sort ENGINE]]" << std::endl;
+            std::exit(1);
+        }
+    }
+    return config;
+}
+
+// Thread counts for a scaling run: 1, 2, 4, ... up to and including maxThreads
+inline std::vector<int> threadCounts(int maxThreads) {
+    std::vector<int> counts;
+    for (int t = 1; t < maxThreads; t *= 2) counts.push_back(t);
+    counts.push_back(maxThreads);
+    return counts;
+}
+
+// Counts the branch mispredictions of the calling thread through perf_event_open.
+// valid() is false where hardware counters are unavailable (other systems, most
+// containers and VMs, perf_event_paranoid > 2).
+class BranchMissCounter {
+public:
+    BranchMissCounter() {
+#ifdef __linux__
+        perf_event_attr attr;
+        std::memset(&attr, 0, sizeof(attr));
+        attr.type = PERF_TYPE_HARDWARE;
+        attr.size = sizeof(attr);
+        attr.config = PERF_COUNT_HW_BRANCH_MISSES;
+        attr.disabled = 1;
+        attr.exclude_kernel = 1;
+        attr.exclude_hv = 1;
+        fd = static_cast<int>(syscall(SYS_perf_event_open, &attr, 0, -1, -1, 0));
+#endif
+    }
+    ~BranchMissCounter() {
+#ifdef __linux__
+        if (fd >= 0) close(fd);
+#endif
+    }
+    BranchMissCounter(const BranchMissCounter&) = delete;
+    BranchMissCounter& operator=(const BranchMissCounter&) = delete;
+
+    bool valid() const { return fd >= 0; }
+
+    void start() {
+#ifdef __linux__
+        ioctl(fd, PERF_EVENT_IOC_RESET, 0);
+        ioctl(fd, PERF_EVENT_IOC_ENABLE, 0);
+#endif
+    }
+
+    // Mispredictions since start()
+    long long stop() {
+        long long count = 0;
+#ifdef __linux__
+        ioctl(fd, PERF_EVENT_IOC_DISABLE, 0);
+        if (read(fd, &count, sizeof(count)) != sizeof(count)) count = 0;
+#endif
+        return count;
+    }
+
+private:
+    int fd = -1;
+};
+
+// Allocations made through CountingAllocator, across all threads
+inline std::atomic<long long>& allocationCount() {
+    static std::atomic<long long> count{0};
+    return count;
+}
+
+// Allocator that counts every allocation in allocationCount(). A container or string
+// using it shows whether a sort copies elements (a copied long string allocates, a moved
+// one does not) or allocates scratch space behind the caller's back.
+template <typename T>
+struct CountingAllocator {
+    using value_type = T;
+
+    CountingAllocator() = default;
+    template <typename U>
+    CountingAllocator(const CountingAllocator<U>&) {}
+
+    T* allocate(size_t n) {
+        allocationCount().fetch_add(1, std::memory_order_relaxed);
+        return std::allocator<T>().allocate(n);
+    }
+    void deallocate(T* p, size_t n) { std::allocator<T>().deallocate(p, n); }
+
+    template <typename U>
+    bool operator==(const CountingAllocator<U>&) const { return true; }
+};
+
+// Percentile of an already sorted sample, with linear interpolation
+inline double percentile(const std::vector<double>& sorted, double p) {
+    if (sorted.empty()) return 0.0;
+    double rank = p * (sorted.size() - 1);
+    size_t lower = static_cast<size_t>(rank);
+    size_t upper = std::min(lower + 1, sorted.size() - 1);
+    double fraction = rank - lower;
+    return sorted[lower] + (sorted[upper] - sorted[lower]) * fraction;
+}
+
+// Turn raw timings into a result
+inline BenchmarkResult summarize(const std::string& name, size_t size, std::vector<double> samples) {
+    BenchmarkResult result;
+    result.name = name;
+    result.size = size;
+    result.repetitions = samples.size();
+    if (samples.empty()) return result;
+
+    std::sort(samples.begin(), samples.end());
+    result.min = samples.front();
+    result.median = percentile(samples, 0.5);
+    result.p95 = percentile(samples, 0.95);
+
+    double sum = 0.0;
+    for (double s : samples) sum += s;
+    result.mean = sum / samples.size();
+
+    double squares = 0.0;
+    for (double s : samples) squares += (s - result.mean) * (s - result.mean);
+    result.stddev = samples.size() > 1 ? std::sqrt(squares / (samples.size() - 1)) : 0.0;
+    return result;
+}
+
+// Run `func` on a fresh copy of `input` warmup + repetitions times.
+// The copy is made before the clock starts, so only the sort itself is timed.
+// With config.branchMisses the timed runs also count mispredicted branches.
+template <typename Func, typename Container>
+BenchmarkResult runBenchmark(const std::string& name, Func func, const Container& input, const BenchmarkConfig& config) {
+    std::vector<double> samples;
+    samples.reserve(config.repetitions);
+    std::unique_ptr<BranchMissCounter> counter;
+    if (config.branchMisses) counter = std::make_unique<BranchMissCounter>();
+    bool counting = counter && counter->valid();
+    long long misses = 0;
+    for (int run = 0; run < config.warmup + config.repetitions; ++run) {
+        Container data = input;
+        if (counting) counter->start();
+        auto start = std::chrono::steady_clock::now();
+        func(data);
+        auto end = std::chrono::steady_clock::now();
+        long long runMisses = counting ? counter->stop() : 0;
+        if (run >= config.warmup) {
+            samples.push_back(std::chrono::duration<double>(end - start).count());
+            misses += runMisses;
+        }
+    }
+    BenchmarkResult result = summarize(name, input.size(), samples);
+    if (counting) result.branchMisses = static_cast<double>(misses) / config.repetitions;
+    return result;
+}
+
+// Print one result in the same sentence style the exercises always used
+inline void printResult(const BenchmarkResult& result) {
+    std::cout << result.name << " (size " << result.size << ") took " << result.median
+              << " seconds (median of " << result.repetitions << " runs; min " << result.min
+              << ", p95 " << result.p95 << ", stddev " << result.stddev;
+    if (result.branchMisses >= 0) std::cout << ", " << result.branchMisses << " branch misses";
+    std::cout << ")." << std::endl;
+}
+
+// Run a benchmark, print it and keep it for the CSV/JSON reports
+template <typename Func, typename Container>
+void recordBenchmark(std::vector<BenchmarkResult>& results, const std::string& name, Func func,
+                     const Container& input, const BenchmarkConfig& config, const std::string& group = "") {
+    BenchmarkResult result = runBenchmark(name, func, input, config);
+    result.group = group;
+    printResult(result);
+    results.push_back(result);
+}
+
+// Write all results to a CSV file
+inline void writeCsv(const std::vector<BenchmarkResult>& results, const std::string& path) {
+    std::ofstream out(path);
+    if (!out) {
+        std::cerr << "Cannot open " << path << " for writing" << std::endl;
+        return;
+    }
+    out << "name,group,size,repetitions,min,median,p95,mean,stddev,branch_misses\n";
+    for (const auto& r : results) {
+        out << '"' << r.name << "\",\"" << r.group << "\"," << r.size << ',' << r.repetitions << ','
+            << r.min << ',' << r.median << ',' << r.p95 << ',' << r.mean << ',' << r.stddev << ','
+            << r.branchMisses << '\n';
+    }
+}
+
+// Escape quotes and backslashes for a JSON string value
+inline std::string jsonEscape(const std::string& text) {
+    std::string escaped;
+    for (char c : text) {
+        if (c == '"' || c == '\\') escaped += '\\';
+        escaped += c;
+    }
+    return escaped;
+}
+
+// Write all results to a JSON file as an array of objects
+inline void writeJson(const std::vector<BenchmarkResult>& results, const std::string& path) {
+    std::ofstream out(path);
+    if (!out) {
+        std::cerr << "Cannot open " << path << " for writing" << std::endl;
+        return;
+    }
+    out << "[\n";
+    for (size_t i = 0; i < results.size(); ++i) {
+        const auto& r = results[i];
+        out << "  {\"name\": \"" << jsonEscape(r.name) << "\", \"group\": \"" << jsonEscape(r.group)
+            << "\", \"size\": " << r.size << ", \"repetitions\": " << r.repetitions
+            << ", \"min\": " << r.min << ", \"median\": " << r.median << ", \"p95\": " << r.p95
+            << ", \"mean\": " << r.mean << ", \"stddev\": " << r.stddev
+            << ", \"branch_misses\": " << r.branchMisses << "}"
+            << (i + 1 < results.size() ? ",\n" : "\n");
+    }
+    out << "]\n";
+}
+
+// Write the CSV and JSON reports requested on the command line
+inline void writeReports(const std::vector<BenchmarkResult>& results, const BenchmarkConfig& config) {
+    if (!config.csvPath.empty()) writeCsv(results, config.csvPath);
+    if (!config.jsonPath.empty()) writeJson(results, config.jsonPath);
+}
@@ -0,0 +1,179 @@
+#pragma once
+
+#include <algorithm>
+#include <cstdint>
+#include <iterator>
+#include <type_traits>
+#include <utility>
+#include <vector>
+#include "Lab4_Parallel.h"
+#include "Lab4_RadixSort.h"
+#include "Lab4_SortingNetwork.h"
+
+// Counting Sort is chosen when the key range is at most this many times the element count
+const long long countingRangeFactor = 2;
+// ... and never needs more counters than this
+const long long maxCountingRange = 1 << 24;
+
+// Whether Counting Sort beats a comparison or radix sort for n keys spread over `range` values
+inline bool preferCountingSort(long long range, long long n) {
+    return range <= maxCountingRange && range <= countingRangeFactor * n;
+}
+
+// max - min for keys in [min, max], in unsigned arithmetic so that no integer type overflows:
+// the span of the full int64/uint64 range is 2^64 - 1
+template <typename T>
+unsigned long long keySpan(T min, T max) {
+    return static_cast<unsigned long long>(max) - static_cast<unsigned long long>(min);
+}
+
+// Counting Sort of [first, last) whose keys all lie in [min, max], with `Count` counters.
+// One histogram pass, then the keys are written back in order: O(n + max - min).
+template <typename Count, typename It, typename T>
+void countingSortWith(It first, It last, T min, T max) {
+    std::vector<Count> count(keySpan(min, max) + 1, 0);
+    for (It it = first; it != last; ++it) {
+        ++count[keySpan(min, *it)];
+    }
+    It out = first;
+    for (size_t v = 0; v < count.size(); ++v) {
+        out = std::fill_n(out, count[v], static_cast<T>(min + v));
+    }
+}
+
+// Counting Sort of [first, last) whose keys all lie in [min, max]. The histogram uses
+// 32-bit counters unless the range holds 2^32 keys or more.
+template <typename It, typename T>
+void countingSort(It first, It last, T min, T max) {
+    static_assert(std::is_integral<T>::value, "Counting Sort needs integer keys");
+    if (last - first < 2) return;
+    if (static_cast<unsigned long long>(last - first) <= UINT32_MAX) countingSortWith<uint32_t>(first, last, min, max);
+    else countingSortWith<uint64_t>(first, last, min, max);
+}
+
+// Counting Sort of arr[low..high] whose keys all lie in [min, max]
+template <typename T>
+void countingSort(std::vector<T>& arr, int low, int high, T min, T max) {
+    if (low >= high) return;
+    countingSort(arr.begin() + low, arr.begin() + high + 1, min, max);
+}
+
+// Parallel Counting Sort of [first, last): every task counts one slice into its own
+// histogram, the histograms are summed, and every task then writes one equal slice of
+// the output. Slices stay below 2^32 keys, so 32-bit counters never overflow.
+template <typename It, typename T>
+void parallelCountingSort(It first, It last, T min, T max, ThreadPool& pool) {
+    static_assert(std::is_integral<T>::value, "Counting Sort needs integer keys");
+    long long n = last - first;
+    if (n < 2) return;
+    size_t range = keySpan(min, max) + 1;
+    int tasks = static_cast<int>(std::max<long long>(pool.threadCount(), (n >> 32) + 1));
+    std::vector<std::vector<uint32_t>> counts(tasks, std::vector<uint32_t>(range, 0));
+    {
+        TaskGroup group(pool);
+        for (int t = 0; t < tasks; ++t) {
+            group.run([&, t] {
+                // Local copies keep the loop free of reloads through captured references
+                uint32_t* count = counts[t].data();
+                It keys = first;
+                T base = min;
+                long long begin = n * t / tasks, end = n * (t + 1) / tasks;
+                for (long long i = begin; i < end; ++i) {
+                    ++count[keySpan(base, keys[i])];
+                }
+            });
+        }
+    }
+
+    // end[v] is the output position just past the last copy of key min + v
+    std::vector<long long> end(range);
+    long long total = 0;
+    for (size_t v = 0; v < range; ++v) {
+        for (int t = 0; t < tasks; ++t) total += counts[t][v];
+        end[v] = total;
+    }
+
+    TaskGroup group(pool);
+    for (int t = 0; t < tasks; ++t) {
+        group.run([&, t] {
+            long long begin = n * t / tasks, stop = n * (t + 1) / tasks;
+            size_t v = std::upper_bound(end.begin(), end.end(), begin) - end.begin();
+            for (long long k = begin; k < stop; ++v) {
+                long long next = std::min(end[v], stop);
+                std::fill(first + k, first + next, static_cast<T>(min + v));
+                k = next;
+            }
+        });
+    }
+    group.wait();
+}
+
+// Parallel Counting Sort of arr[low..high] whose keys all lie in [min, max]
+template <typename T>
+void parallelCountingSort(std::vector<T>& arr, int low, int high, T min, T max, ThreadPool& pool) {
+    if (low >= high) return;
+    parallelCountingSort(arr.begin() + low, arr.begin() + high + 1, min, max, pool);
+}
+
+// Integer sort of [first, last) for keys known to lie in [min, max]: a sorting network for
+// tiny ranges, Counting Sort when the key range is small compared to the number of keys,
+// LSD Radix Sort otherwise
+template <typename It, typename T>
+void integerSort(It first, It last, T min, T max, std::vector<std::iter_value_t<It>>& buffer) {
+    long long n = last - first;
+    if (n < 2) return;
+    if constexpr (vectorizable<It, std::less<>>) {
+        if (n <= networkMaxElements) {
+            networkSort(std::to_address(first), static_cast<int>(n));
+            return;
+        }
+    }
+    // The span is checked before it becomes a long long: a full 64-bit key range would wrap
+    unsigned long long span = keySpan(min, max);
+    if (span < static_cast<unsigned long long>(maxCountingRange) && preferCountingSort(span + 1, n)) {
+        countingSort(first, last, min, max);
+    } else {
+        lsdRadixSort(first, last, buffer);
+    }
+}
+
+// Integer sort of arr[low..high] for keys known to lie in [min, max]
+template <typename T>
+void integerSort(std::vector<T>& arr, int low, int high, T min, T max, std::vector<T>& buffer) {
+    if (low >= high) return;
+    integerSort(arr.begin() + low, arr.begin() + high + 1, min, max, buffer);
+}
+
+// Smallest and largest key of the non-empty range [first, last).
+// A plain min/max loop vectorizes; std::minmax_element compares neighbours with a
+// data-dependent branch and is several times slower on random keys.
+template <typename It>
+auto keyRange(It first, It last) {
+    auto min = *first, max = *first;
+    for (It it = first + 1; it != last; ++it) {
+        min = std::min(min, *it);
+        max = std::max(max, *it);
+    }
+    return std::pair(min, max);
+}
+
+// Smallest and largest key of arr[low..high]
+template <typename T>
+std::pair<T, T> keyRange(const std::vector<T>& arr, int low, int high) {
+    return keyRange(arr.begin() + low, arr.begin() + high + 1);
+}
+
+// Integer sort of [first, last) when the key range is not known: a quick min/max scan picks the path
+template <typename It>
+void integerSort(It first, It last, std::vector<std::iter_value_t<It>>& buffer) {
+    if (last - first < 2) return;
+    auto [min, max] = keyRange(first, last);
+    integerSort(first, last, min, max, buffer);
+}
+
+// Integer sort of arr[low..high] when the key range is not known
+template <typename T>
+void integerSort(std::vector<T>& arr, int low, int high, std::vector<T>& buffer) {
+    if (low >= high) return;
+    integerSort(arr.begin() + low, arr.begin() + high + 1, buffer);
+}
@@ -3,19 +3,19 @@
 #include <chrono>
 #include <random>
 #include <algorithm>
+#include "Lab4_Benchmark.h"
+#include "Lab4_Generators.h"
+#include "Lab4_IntroSort.h"
+#include "Lab4_MergeSort.h"
+#include "Lab4_RadixSort.h"
+#include "Lab4_CountingSort.h"
+#include "Lab4_AdaptiveSort.h"
 
 using namespace std;
 
 //generate a list of random integers
 vector<int> generateRandomList(int size, int min = 1, int max = 1000) {
-    vector<int> list(size);
-    random_device rd;
-    mt19937 gen(rd());
-    uniform_int_distribution<> dist(min, max);
-    for (int& num : list) {
-        num = dist(gen);
-    }
-    return list;
+    return generateList(Distribution::Uniform, size, min, max);
 }
 
 // Selection Sort
@@ -105,24 +105,30 @@ void mergeSort(vector<int>& arr, int left, int right) {
     }
 }
 
-// Helper function to measure execution time
-template <typename Func>
-void measureTime(Func func, vector<int> arr, const string& sortName) {
-    auto start = chrono::high_resolution_clock::now();
-    func(arr);
-    auto end = chrono::high_resolution_clock::now();
-    chrono::duration<double> duration = end - start;
-    cout << sortName << " took " << duration.count() << " seconds for the process."<<endl;
-}
+int main(int argc, char* argv[]) {
+    BenchmarkConfig config = parseBenchmarkArgs(argc, argv);
+    vector<BenchmarkResult> results;
 
-int main() {
     int size = 1000;
-    auto originalList = generateRandomList(size);
-    measureTime(selectionSort, originalList, "Selection Sort");
-    measureTime(bubbleSort, originalList, "Bubble Sort");
-    measureTime(insertionSort, originalList, "Insertion Sort");
-    measureTime([&](vector<int> arr) { quickSort(arr, 0, arr.size() - 1); }, originalList, "Quick Sort");
-    measureTime([&](vector<int> arr) { mergeSort(arr, 0, arr.size() - 1); }, originalList, "Merge Sort");
+    vector<int> buffer; // scratch space reused by every Buffered Merge Sort run
+    for (Distribution dist : allDistributions()) {
+        auto originalList = generateList(dist, size);
+        string name = distributionName(dist);
+        cout << "Distribution: " << name << endl;
+        recordBenchmark(results, "Selection Sort", selectionSort, originalList, config, name);
+        recordBenchmark(results, "Bubble Sort", bubbleSort, originalList, config, name);
+        recordBenchmark(results, "Insertion Sort", [](vector<int>& arr) { insertionSort(arr); }, originalList, config, name);
+        recordBenchmark(results, "Quick Sort", [](vector<int>& arr) { quickSort(arr, 0, arr.size() - 1); }, originalList, config, name);
+        recordBenchmark(results, "Intro Sort", [](vector<int>& arr) { introSort(arr, 0, arr.size() - 1); }, originalList, config, name);
+        recordBenchmark(results, "Merge Sort", [](vector<int>& arr) { mergeSort(arr, 0, arr.size() - 1); }, originalList, config, name);
+        recordBenchmark(results, "Buffered Merge Sort", [&buffer](vector<int>& arr) { bufferedMergeSort(arr, 0, arr.size() - 1, buffer); }, originalList, config, name);
+        recordBenchmark(results, "LSD Radix Sort", [&buffer](vector<int>& arr) { lsdRadixSort(arr, 0, arr.size() - 1, buffer); }, originalList, config, name);
+        recordBenchmark(results, "MSD Radix Sort", [](vector<int>& arr) { msdRadixSort(arr, 0, arr.size() - 1); }, originalList, config, name);
+        recordBenchmark(results, "Integer Sort", [&buffer](vector<int>& arr) { integerSort(arr, 0, arr.size() - 1, buffer); }, originalList, config, name);
+        explainSort(originalList, cout);
+        recordBenchmark(results, "Adaptive Sort", [](vector<int>& arr) { adaptiveSort(arr); }, originalList, config, name);
+    }
 
+    writeReports(results, config);
     return 0;
 }
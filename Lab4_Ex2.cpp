@@ -3,19 +3,19 @@
 #include <chrono>
 #include <random>
 #include <algorithm>
+#include "Lab4_Benchmark.h"
+#include "Lab4_Generators.h"
+#include "Lab4_IntroSort.h"
+#include "Lab4_MergeSort.h"
+#include "Lab4_RadixSort.h"
+#include "Lab4_CountingSort.h"
+#include "Lab4_AdaptiveSort.h"
 
 using namespace std;
 
 // Function to generate a list of random integers
 vector<int> generateRandomList(int size, int min = 1, int max = 1000) {
-    vector<int> list(size);
-    random_device rd;
-    mt19937 gen(rd());
-    uniform_int_distribution<> dist(min, max);
-    for (int& num : list) {
-        num = dist(gen);
-    }
-    return list;
+    return generateList(Distribution::Uniform, size, min, max);
 }
 
 // Selection Sort
@@ -105,29 +105,65 @@ void mergeSort(vector<int>& arr, int left, int right) {
     }
 }
 
-// function to measure execution time
-template <typename Func>
-double measureTime(Func func, vector<int> arr) {
-    auto start = chrono::high_resolution_clock::now();
-    func(arr);
-    auto end = chrono::high_resolution_clock::now();
-    chrono::duration<double> duration = end - start;
-    return duration.count();
-}
+int main(int argc, char* argv[]) {
+    BenchmarkConfig config = parseBenchmarkArgs(argc, argv);
+    vector<BenchmarkResult> results;
 
-int main() {
     vector<int> sizes = { 100, 1000, 10000 };
+    vector<int> buffer; // scratch space reused by every Buffered Merge Sort run
     for (int size : sizes) {
         auto originalList = generateRandomList(size);
         cout << "Array size: " << size << endl;
-        cout << "Selection Sort took " << measureTime(selectionSort, originalList) << " seconds for the process."<<endl;
-        cout << "Bubble Sort took " << measureTime(bubbleSort, originalList) << " seconds for the process."<<endl;
-        cout << "Insertion Sort took " << measureTime(insertionSort, originalList) << " seconds for the process."<<endl;
-        cout << "Quick Sort took " << measureTime([&](vector<int> arr) { quickSort(arr, 0, arr.size() - 1); }, originalList) << " seconds for the process."<<endl;
-        cout << "Merge Sort took " << measureTime([&](vector<int> arr) { mergeSort(arr, 0, arr.size() - 1); }, originalList) << " seconds for the process."<<endl;
+        recordBenchmark(results, "Selection Sort", selectionSort, originalList, config);
+        recordBenchmark(results, "Bubble Sort", bubbleSort, originalList, config);
+        recordBenchmark(results, "Insertion Sort", [](vector<int>& arr) { insertionSort(arr); }, originalList, config);
+        recordBenchmark(results, "Quick Sort", [](vector<int>& arr) { quickSort(arr, 0, arr.size() - 1); }, originalList, config);
+        recordBenchmark(results, "Intro Sort", [](vector<int>& arr) { introSort(arr, 0, arr.size() - 1); }, originalList, config);
+        recordBenchmark(results, "Merge Sort", [](vector<int>& arr) { mergeSort(arr, 0, arr.size() - 1); }, originalList, config);
+        recordBenchmark(results, "Buffered Merge Sort", [&buffer](vector<int>& arr) { bufferedMergeSort(arr, 0, arr.size() - 1, buffer); }, originalList, config);
+        recordBenchmark(results, "LSD Radix Sort", [&buffer](vector<int>& arr) { lsdRadixSort(arr, 0, arr.size() - 1, buffer); }, originalList, config);
+        recordBenchmark(results, "MSD Radix Sort", [](vector<int>& arr) { msdRadixSort(arr, 0, arr.size() - 1); }, originalList, config);
+        recordBenchmark(results, "Counting Sort", [](vector<int>& arr) { countingSort(arr, 0, arr.size() - 1, 1, 1000); }, originalList, config);
+        recordBenchmark(results, "Integer Sort", [&buffer](vector<int>& arr) { integerSort(arr, 0, arr.size() - 1, buffer); }, originalList, config);
+        explainSort(originalList, cout);
+        recordBenchmark(results, "Adaptive Sort", [](vector<int>& arr) { adaptiveSort(arr); }, originalList, config);
         
         cout << "----------------------------------------" << endl;
     }
+
+    // Large input: only the O(n log n) and linear-time sorts, compared with std::sort
+    {
+        int size = 1000000;
+        auto largeList = generateList(Distribution::Uniform, size, 0, 1000000000);
+        cout << "Array size: " << size << endl;
+        recordBenchmark(results, "std::sort", [](vector<int>& arr) { sort(arr.begin(), arr.end()); }, largeList, config);
+        recordBenchmark(results, "Intro Sort", [](vector<int>& arr) { introSort(arr, 0, arr.size() - 1); }, largeList, config);
+        recordBenchmark(results, "LSD Radix Sort", [&buffer](vector<int>& arr) { lsdRadixSort(arr, 0, arr.size() - 1, buffer); }, largeList, config);
+        recordBenchmark(results, "MSD Radix Sort", [](vector<int>& arr) { msdRadixSort(arr, 0, arr.size() - 1); }, largeList, config);
+        explainSort(largeList, cout);
+        recordBenchmark(results, "Adaptive Sort", [](vector<int>& arr) { adaptiveSort(arr); }, largeList, config);
+
+        cout << "----------------------------------------" << endl;
+    }
+
+    // Large input with the default [1, 1000] keys, where Counting Sort needs one pass
+    {
+        int size = 1000000;
+        auto boundedList = generateRandomList(size);
+        ThreadPool pool(config.threads);
+        cout << "Array size: " << size << " (keys in [1, 1000])" << endl;
+        recordBenchmark(results, "std::sort", [](vector<int>& arr) { sort(arr.begin(), arr.end()); }, boundedList, config);
+        recordBenchmark(results, "Counting Sort", [](vector<int>& arr) { countingSort(arr, 0, arr.size() - 1, 1, 1000); }, boundedList, config);
+        recordBenchmark(results, "Parallel Counting Sort", [&pool](vector<int>& arr) {
+            parallelCountingSort(arr, 0, arr.size() - 1, 1, 1000, pool);
+        }, boundedList, config);
+        recordBenchmark(results, "Integer Sort", [&buffer](vector<int>& arr) { integerSort(arr, 0, arr.size() - 1, buffer); }, boundedList, config);
+        explainSort(boundedList, cout);
+        recordBenchmark(results, "Adaptive Sort", [](vector<int>& arr) { adaptiveSort(arr); }, boundedList, config);
+
+        cout << "----------------------------------------" << endl;
+    }
     
+    writeReports(results, config);
     return 0;
 }
@@ -4,16 +4,34 @@
 #include <random>
 #include <string>
 #include <algorithm>
+#include <iterator>
+#include <array>
+#include <deque>
+#include <functional>
+#include <span>
+#include <memory>
 #include <type_traits>
+#include <cstdint>
+#include <limits>
+#include "Lab4_Benchmark.h"
+#include "Lab4_Generators.h"
+#include "Lab4_InsertionSort.h"
+#include "Lab4_IntroSort.h"
+#include "Lab4_Partition.h"
+#include "Lab4_MergeSort.h"
+#include "Lab4_RadixSort.h"
+#include "Lab4_AdaptiveSort.h"
+#include "Lab4_IndexSort.h"
+#include "Lab4_StringSort.h"
+#include "Lab4_Ranges.h"
 
 using namespace std;
 
 // Function to generate a list of random integers, floating-point numbers, or strings
 template <typename T>
-vector<T> generateRandomList(int size, T min, T max) {
+vector<T> generateRandomList(int size, T min, T max, unsigned seed = defaultSeed) {
     vector<T> list(size);
-    random_device rd;
-    mt19937 gen(rd());
+    mt19937 gen(seed);
 
     if constexpr (is_integral<T>::value) { // Integer generation
         uniform_int_distribution<> dist(min, max);
@@ -37,112 +55,201 @@ vector<T> generateRandomList(int size, T min, T max) {
     return list;
 }
 
-// Selection Sort
-template <typename T>
-void selectionSort(vector<T>& arr) {
-    int n = arr.size();
-    for (int i = 0; i < n - 1; ++i) {
-        int minIdx = i;
-        for (int j = i + 1; j < n; ++j) {
-            if (arr[j] < arr[minIdx]) {
-                minIdx = j;
-            }
-        }
-        swap(arr[i], arr[minIdx]);
+// A record with a small key and a large payload, like the rows real data sorts by one column
+struct Record {
+    int key = 0;
+    string name;
+    array<char, 240> payload{};
+};
+
+bool operator<(const Record& a, const Record& b) { return a.key < b.key; }
+bool operator>(const Record& a, const Record& b) { return b < a; }
+bool operator<=(const Record& a, const Record& b) { return !(b < a); }
+
+// Index Sort prefix of a record: its key
+uint64_t keyPrefix(const Record& record) { return keyPrefix(record.key); }
+
+// Records with random keys in [1, 1000]
+vector<Record> generateRecords(int size) {
+    vector<Record> records(size);
+    auto keys = generateRandomList<int>(size, 1, 1000);
+    for (int i = 0; i < size; ++i) {
+        records[i].key = keys[i];
+        records[i].name = "record-" + to_string(i);
     }
+    return records;
 }
 
-// Bubble Sort
-template <typename T>
-void bubbleSort(vector<T>& arr) {
-    int n = arr.size();
-    for (int i = 0; i < n - 1; ++i) {
-        for (int j = 0; j < n - i - 1; ++j) {
-            if (arr[j] > arr[j + 1]) {
-                swap(arr[j], arr[j + 1]);
+// Strings whose heap allocations are counted: a sort that copies them shows up in allocationCount()
+using CountedString = basic_string<char, char_traits<char>, CountingAllocator<char>>;
+
+// Long strings with shared prefixes, like URLs: 16 common paths and a random item number
+vector<string> generateUrlList(int size) {
+    auto keys = generateRandomList<int>(size, 0, 99999999);
+    vector<string> list(size);
+    for (int i = 0; i < size; ++i) {
+        list[i] = "https://example.com/catalog/section-" + to_string(keys[i] % 16) + "/item-" + to_string(keys[i]);
+    }
+    return list;
+}
+
+// Selection Sort of [first, last) by `comp`
+template <typename It, typename Compare = less<>>
+    requires random_access_iterator<It>
+void selectionSort(It first, It last, Compare comp = {}) {
+    for (It i = first; last - i > 1; ++i) {
+        It minIt = i;
+        for (It j = i + 1; j < last; ++j) {
+            if (comp(*j, *minIt)) {
+                minIt = j;
             }
         }
+        iter_swap(i, minIt);
     }
 }
 
-// Insertion Sort
 template <typename T>
-void insertionSort(vector<T>& arr) {
-    int n = arr.size();
-    for (int i = 1; i < n; ++i) {
-        T key = arr[i];
-        int j = i - 1;
-        while (j >= 0 && arr[j] > key) {
-            arr[j + 1] = arr[j];
-            --j;
+void selectionSort(vector<T>& arr) {
+    selectionSort(arr.begin(), arr.end());
+}
+
+// Bubble Sort of [first, last) by `comp`
+template <typename It, typename Compare = less<>>
+    requires random_access_iterator<It>
+void bubbleSort(It first, It last, Compare comp = {}) {
+    for (It end = last; end - first > 1; --end) {
+        for (It j = first; j + 1 < end; ++j) {
+            if (comp(*(j + 1), *j)) {
+                iter_swap(j, j + 1);
+            }
         }
-        arr[j + 1] = key;
     }
 }
 
-// Quick Sort
 template <typename T>
-int partition(vector<T>& arr, int low, int high) {
-    T pivot = arr[high];
-    int i = low - 1;
-    for (int j = low; j < high; ++j) {
-        if (arr[j] <= pivot) {
-            ++i;
-            swap(arr[i], arr[j]);
-        }
+void bubbleSort(vector<T>& arr) {
+    bubbleSort(arr.begin(), arr.end());
+}
+
+// Insertion Sort is the move-based one of Lab4_InsertionSort.h
+
+// Quick Sort of [first, last) by `comp`, with the Lomuto partition of Lab4_Partition.h
+template <typename It, typename Compare = less<>>
+    requires random_access_iterator<It>
+void quickSort(It first, It last, Compare comp = {}) {
+    if (last - first > 1) {
+        It pivot = lomutoPartition(first, last, comp);
+        quickSort(first, pivot, comp);
+        quickSort(pivot + 1, last, comp);
     }
-    swap(arr[i + 1], arr[high]);
-    return i + 1;
 }
 
 template <typename T>
 void quickSort(vector<T>& arr, int low, int high) {
-    if (low < high) {
-        int pi = partition(arr, low, high);
-        quickSort(arr, low, pi - 1);
-        quickSort(arr, pi + 1, high);
+    if (low < high) quickSort(arr.begin() + low, arr.begin() + high + 1);
+}
+
+// Merge the sorted halves [first, mid) and [mid, last); ties take from the left half
+template <typename It, typename Compare>
+void mergeHalves(It first, It mid, It last, Compare comp) {
+    // Move the halves out instead of copying them
+    vector<iter_value_t<It>> L(make_move_iterator(first), make_move_iterator(mid));
+    vector<iter_value_t<It>> R(make_move_iterator(mid), make_move_iterator(last));
+    auto i = L.begin(), j = R.begin();
+    It k = first;
+    while (i != L.end() && j != R.end()) {
+        if (comp(*j, *i)) *k++ = move(*j++);
+        else *k++ = move(*i++);
     }
+    k = move(i, L.end(), k);
+    move(j, R.end(), k);
 }
 
-// Merge Sort
-template <typename T>
-void merge(vector<T>& arr, int left, int mid, int right) {
-    int n1 = mid - left + 1;
-    int n2 = right - mid;
-    vector<T> L(n1), R(n2);
-    for (int i = 0; i < n1; ++i) L[i] = arr[left + i];
-    for (int j = 0; j < n2; ++j) R[j] = arr[mid + 1 + j];
-    int i = 0, j = 0, k = left;
-    while (i < n1 && j < n2) {
-        if (L[i] <= R[j]) arr[k++] = L[i++];
-        else arr[k++] = R[j++];
+// Merge Sort of [first, last) by `comp`
+template <typename It, typename Compare = less<>>
+    requires random_access_iterator<It>
+void mergeSort(It first, It last, Compare comp = {}) {
+    if (last - first > 1) {
+        It mid = first + (last - first) / 2;
+        mergeSort(first, mid, comp);
+        mergeSort(mid, last, comp);
+        mergeHalves(first, mid, last, comp);
     }
-    while (i < n1) arr[k++] = L[i++];
-    while (j < n2) arr[k++] = R[j++];
 }
 
 template <typename T>
 void mergeSort(vector<T>& arr, int left, int right) {
-    if (left < right) {
-        int mid = left + (right - left) / 2;
-        mergeSort(arr, left, mid);
-        mergeSort(arr, mid + 1, right);
-        merge(arr, left, mid, right);
+    if (left < right) mergeSort(arr.begin() + left, arr.begin() + right + 1);
+}
+
+// Benchmark every sort on one list, labelling the results with the element type
+template <typename T>
+void benchmarkAll(vector<BenchmarkResult>& results, const vector<T>& list, const string& type, const BenchmarkConfig& config) {
+    recordBenchmark(results, "Selection Sort", [](vector<T>& arr) { selectionSort(arr); }, list, config, type);
+    recordBenchmark(results, "Bubble Sort", [](vector<T>& arr) { bubbleSort(arr); }, list, config, type);
+    recordBenchmark(results, "Insertion Sort", [](vector<T>& arr) { insertionSort(arr); }, list, config, type);
+    recordBenchmark(results, "Quick Sort", [](vector<T>& arr) { quickSort(arr, 0, arr.size() - 1); }, list, config, type);
+    recordBenchmark(results, "Intro Sort", [](vector<T>& arr) { introSort(arr, 0, arr.size() - 1); }, list, config, type);
+    recordBenchmark(results, "Merge Sort", [](vector<T>& arr) { mergeSort(arr, 0, arr.size() - 1); }, list, config, type);
+    vector<T> buffer; // scratch space reused by every Buffered Merge Sort run
+    recordBenchmark(results, "Buffered Merge Sort", [&buffer](vector<T>& arr) { bufferedMergeSort(arr, 0, arr.size() - 1, buffer); }, list, config, type);
+    if constexpr (is_arithmetic<T>::value) { // Radix sorts need numeric keys
+        recordBenchmark(results, "LSD Radix Sort", [&buffer](vector<T>& arr) { lsdRadixSort(arr, 0, arr.size() - 1, buffer); }, list, config, type);
+        recordBenchmark(results, "MSD Radix Sort", [](vector<T>& arr) { msdRadixSort(arr, 0, arr.size() - 1); }, list, config, type);
+        // The range front ends: a comparator costs nothing next to the index versions above
+        recordBenchmark(results, "Intro Sort (span)", [](vector<T>& arr) { introSort(span<T>(arr)); }, list, config, type);
+        recordBenchmark(results, "Intro Sort (descending)", [](vector<T>& arr) { introSort(arr, ranges::greater{}); }, list, config, type);
+        recordBenchmark(results, "LSD Radix Sort (descending)", [](vector<T>& arr) { lsdRadixSort(arr, ranges::greater{}); }, list, config, type);
     }
+    recordBenchmark(results, "Index Sort", [](vector<T>& arr) { indexSort(arr); }, list, config, type);
+    explainSort(list, cout);
+    recordBenchmark(results, "Adaptive Sort", [](vector<T>& arr) { adaptiveSort(arr); }, list, config, type);
+}
+
+// Sort a copy of `list` and report how many string allocations the sort itself made.
+// Sorts that move their elements make none; every copy of a long string makes one.
+// Returns false if the sort allocated or left the list out of order.
+template <typename Func>
+bool checkAllocations(const string& name, const vector<CountedString>& list, Func sortFunc) {
+    auto arr = list;
+    allocationCount() = 0;
+    sortFunc(arr);
+    long long allocations = allocationCount();
+    bool sorted = is_sorted(arr.begin(), arr.end());
+    cout << name << ": " << allocations << " string allocations, " << (sorted ? "sorted" : "NOT SORTED") << endl;
+    return allocations == 0 && sorted;
+}
+
+// Sort a copy of `records` through unique_ptr, which can only be moved, and check the order.
+// Returns false if the result is not sorted.
+template <typename Func>
+bool checkMoveOnly(const string& name, const vector<Record>& records, Func sortFunc) {
+    vector<unique_ptr<Record>> arr;
+    for (const auto& record : records) arr.push_back(make_unique<Record>(record));
+    auto byKey = [](const unique_ptr<Record>& a, const unique_ptr<Record>& b) { return a->key < b->key; };
+    sortFunc(arr, byKey);
+    bool sorted = is_sorted(arr.begin(), arr.end(), byKey);
+    cout << name << " (unique_ptr<Record>): " << (sorted ? "sorted" : "NOT SORTED") << endl;
+    return sorted;
 }
 
-// Helper function to measure execution time
-template <typename Func, typename T>
-double measureTime(Func func, vector<T> arr) {
-    auto start = chrono::high_resolution_clock::now();
-    func(arr);
-    auto end = chrono::high_resolution_clock::now();
-    chrono::duration<double> duration = end - start;
-    return duration.count();
+// The string engines next to std::sort
+void benchmarkStrings(vector<BenchmarkResult>& results, const vector<string>& list, const string& type,
+                      const BenchmarkConfig& config, ThreadPool& pool) {
+    recordBenchmark(results, "std::sort", [](vector<string>& arr) { sort(arr.begin(), arr.end()); }, list, config, type);
+    recordBenchmark(results, "Multikey Quick Sort", [](vector<string>& arr) { multikeyQuickSort(arr, 0, arr.size() - 1); }, list, config, type);
+    recordBenchmark(results, "Cached-Prefix Radix Sort", [](vector<string>& arr) { cachedPrefixRadixSort(arr, 0, arr.size() - 1); }, list, config, type);
+    recordBenchmark(results, "LCP Merge Sort", [](vector<string>& arr) { lcpMergeSort(arr, 0, arr.size() - 1); }, list, config, type);
+    recordBenchmark(results, "Parallel String Sample Sort", [&pool](vector<string>& arr) {
+        parallelStringSampleSort(arr, 0, arr.size() - 1, pool);
+    }, list, config, type);
 }
 
-int main() {
+int main(int argc, char* argv[]) {
+    BenchmarkConfig config = parseBenchmarkArgs(argc, argv);
+    vector<BenchmarkResult> results;
     vector<int> sizes = {100, 1000, 10000}; // Array sizes to test
+    ThreadPool pool(config.threads);
     
     for (int size : sizes) {
         cout << "\nArray size: " << size << endl;
@@ -150,30 +257,116 @@ int main() {
         // Test with integers
         cout << "\nTesting with integers:" << endl;
         auto intList = generateRandomList<int>(size, 1, 1000);
-        cout << "Selection Sort took " << measureTime(selectionSort<int>, intList) << " seconds."<<endl;
-        cout << "Bubble Sort took " << measureTime(bubbleSort<int>, intList) << " seconds."<<endl;
-        cout << "Insertion Sort took " << measureTime(insertionSort<int>, intList) << " seconds."<<endl;
-        cout << "Quick Sort took " << measureTime([&](vector<int> arr) { quickSort(arr, 0, arr.size() - 1); }, intList) << " seconds."<<endl;
-        cout << "Merge Sort took " << measureTime([&](vector<int> arr) { mergeSort(arr, 0, arr.size() - 1); }, intList) << " seconds."<<endl;
+        benchmarkAll(results, intList, "int", config);
         
         // Test with floating-point numbers
         cout << "\nTesting with floating-point numbers:" << endl;
         auto floatList = generateRandomList<double>(size, 1.0, 1000.0);
-        cout << "Selection Sort took " << measureTime(selectionSort<double>, floatList) << " seconds."<<endl;
-        cout << "Bubble Sort took " << measureTime(bubbleSort<double>, floatList) << " seconds."<<endl;
-        cout << "Insertion Sort took " << measureTime(insertionSort<double>, floatList) << " seconds."<<endl;
-        cout << "Quick Sort took " << measureTime([&](vector<double> arr) { quickSort(arr, 0, arr.size() - 1); }, floatList) << " seconds."<<endl;
-        cout << "Merge Sort took " << measureTime([&](vector<double> arr) { mergeSort(arr, 0, arr.size() - 1); }, floatList) << " seconds."<<endl;
+        benchmarkAll(results, floatList, "double", config);
 
         // Test with strings
         cout << "\nTesting with strings:" << endl;
         auto strList = generateRandomList<string>(size, "", "");
-        cout << "Selection Sort took " << measureTime(selectionSort<string>, strList) << " seconds."<<endl;
-        cout << "Bubble Sort took " << measureTime(bubbleSort<string>, strList) << " seconds."<<endl;
-        cout << "Insertion Sort took " << measureTime(insertionSort<string>, strList) << " seconds."<<endl;
-        cout << "Quick Sort took " << measureTime([&](vector<string> arr) { quickSort(arr, 0, arr.size() - 1); }, strList) << " seconds."<<endl;
-        cout << "Merge Sort took " << measureTime([&](vector<string> arr) { mergeSort(arr, 0, arr.size() - 1); }, strList) << " seconds."<<endl;
+        benchmarkAll(results, strList, "string", config);
+        benchmarkStrings(results, strList, "string", config, pool);
+
+        // Test with long strings that share long prefixes
+        cout << "\nTesting with long strings (shared prefixes):" << endl;
+        auto urlList = generateUrlList(size);
+        recordBenchmark(results, "Intro Sort", [](vector<string>& arr) { introSort(arr, 0, arr.size() - 1); }, urlList, config, "long string");
+        recordBenchmark(results, "Merge Sort", [](vector<string>& arr) { mergeSort(arr, 0, arr.size() - 1); }, urlList, config, "long string");
+        recordBenchmark(results, "Index Sort", [](vector<string>& arr) { indexSort(arr); }, urlList, config, "long string");
+        benchmarkStrings(results, urlList, "long string", config, pool);
+
+        // Test with large records: index sorting moves each record once
+        cout << "\nTesting with records (" << sizeof(Record) << " bytes):" << endl;
+        auto recordList = generateRecords(size);
+        recordBenchmark(results, "Intro Sort", [](vector<Record>& arr) { introSort(arr, 0, arr.size() - 1); }, recordList, config, "record");
+        recordBenchmark(results, "Merge Sort", [](vector<Record>& arr) { mergeSort(arr, 0, arr.size() - 1); }, recordList, config, "record");
+        recordBenchmark(results, "std::stable_sort", [](vector<Record>& arr) { stable_sort(arr.begin(), arr.end()); }, recordList, config, "record");
+        recordBenchmark(results, "Index Sort", [](vector<Record>& arr) { indexSort(arr); }, recordList, config, "record");
+        recordBenchmark(results, "Sort Permutation", [](vector<Record>& arr) { sortPermutation(arr); }, recordList, config, "record");
+        recordBenchmark(results, "Intro Sort (by key)", [](vector<Record>& arr) { introSort(arr, {}, &Record::key); }, recordList, config, "record");
+        recordBenchmark(results, "Index Sort (by key)", [](vector<Record>& arr) { indexSort(arr, {}, &Record::key); }, recordList, config, "record");
+        recordBenchmark(results, "LSD Radix Sort (by key)", [](vector<Record>& arr) { lsdRadixSort(arr, {}, &Record::key); }, recordList, config, "record");
     }
 
+    // The generic sorts move elements instead of copying them, so long strings sort
+    // without a single allocation and move-only elements sort at all; any failed check
+    // makes the program exit with 1
+    bool passed = true;
+    cout << "\nAllocation check (long strings):" << endl;
+    vector<CountedString> countedList;
+    for (const auto& url : generateUrlList(2000)) countedList.emplace_back(url.begin(), url.end());
+    passed &= checkAllocations("Insertion Sort", countedList, [](vector<CountedString>& arr) { insertionSort(arr); });
+    passed &= checkAllocations("Quick Sort", countedList, [](vector<CountedString>& arr) { quickSort(arr, 0, arr.size() - 1); });
+    passed &= checkAllocations("Merge Sort", countedList, [](vector<CountedString>& arr) { mergeSort(arr, 0, arr.size() - 1); });
+    passed &= checkAllocations("Intro Sort", countedList, [](vector<CountedString>& arr) { introSort(arr, 0, arr.size() - 1); });
+    passed &= checkAllocations("Buffered Merge Sort", countedList, [](vector<CountedString>& arr) { bufferedMergeSort(arr, 0, arr.size() - 1); });
+    passed &= checkAllocations("Natural Merge Sort", countedList, [](vector<CountedString>& arr) { naturalMergeSort(arr, 0, arr.size() - 1); });
+    passed &= checkAllocations("Heap Sort", countedList, [](vector<CountedString>& arr) { heapSort(arr, 0, arr.size() - 1); });
+
+    cout << "\nMove-only check:" << endl;
+    auto records = generateRecords(2000);
+    passed &= checkMoveOnly("Insertion Sort", records, [](auto& arr, auto comp) { insertionSort(arr.begin(), arr.end(), comp); });
+    passed &= checkMoveOnly("Quick Sort", records, [](auto& arr, auto comp) { quickSort(arr.begin(), arr.end(), comp); });
+    passed &= checkMoveOnly("Merge Sort", records, [](auto& arr, auto comp) { mergeSort(arr.begin(), arr.end(), comp); });
+    passed &= checkMoveOnly("Intro Sort", records, [](auto& arr, auto comp) { introSort(arr.begin(), arr.end(), comp); });
+    passed &= checkMoveOnly("Buffered Merge Sort", records, [](auto& arr, auto comp) { bufferedMergeSort(arr.begin(), arr.end(), comp); });
+    passed &= checkMoveOnly("Natural Merge Sort", records, [](auto& arr, auto comp) { naturalMergeSort(arr.begin(), arr.end(), comp); });
+    passed &= checkMoveOnly("Heap Sort", records, [](auto& arr, auto comp) { heapSort(arr.begin(), arr.end(), comp); });
+
+    // The range front ends take any random-access range, a comparator and a projection
+    cout << "\nRanges check:" << endl;
+    auto checkSorted = [&passed](const string& name, bool sorted) {
+        cout << name << ": " << (sorted ? "sorted" : "NOT SORTED") << endl;
+        passed &= sorted;
+    };
+    array<double, 1000> fixed;
+    auto doubles = generateRandomList<double>(fixed.size(), 1.0, 1000.0);
+    copy(doubles.begin(), doubles.end(), fixed.begin());
+    heapSort(fixed);
+    checkSorted("Heap Sort (std::array<double>)", ranges::is_sorted(fixed));
+    auto ints = generateRandomList<int>(20000, -1000000, 1000000);
+    deque<int> queue(ints.begin(), ints.end());
+    introSort(queue);
+    checkSorted("Intro Sort (std::deque<int>)", ranges::is_sorted(queue));
+    // A sub-range of a raw buffer, as a memory-mapped file would be
+    auto raw = make_unique<int[]>(ints.size());
+    copy(ints.begin(), ints.end(), raw.get());
+    span<int> middle(raw.get() + 1000, ints.size() - 2000);
+    msdRadixSort(middle);
+    checkSorted("MSD Radix Sort (span sub-range)", ranges::is_sorted(middle));
+    naturalMergeSort(ints, ranges::greater{});
+    checkSorted("Natural Merge Sort (descending)", ranges::is_sorted(ints, ranges::greater{}));
+    auto byName = generateRecords(2000);
+    lcpMergeSort(byName, {}, &Record::name);
+    checkSorted("LCP Merge Sort (records by name)", ranges::is_sorted(byName, {}, &Record::name));
+    // std::pair has no keyPrefix, so its permutation is ordered by comparisons alone
+    vector<pair<int, int>> pairs;
+    for (int i = 0; i < 2000; ++i) pairs.emplace_back(ints[i] % 100, i);
+    indexSort(pairs, ranges::greater{});
+    checkSorted("Index Sort (pairs, descending)", ranges::is_sorted(pairs, ranges::greater{}));
+    auto byKey = generateRecords(2000);
+    integerSort(byKey, ranges::greater{}, &Record::key);
+    checkSorted("Integer Sort (records by key, descending)", ranges::is_sorted(byKey, ranges::greater{}, &Record::key));
+    // 64-bit keys spanning their whole range, where max - min does not fit in a long long
+    mt19937_64 gen64(defaultSeed);
+    vector<int64_t> wideSigned = {numeric_limits<int64_t>::min(), numeric_limits<int64_t>::max()};
+    vector<uint64_t> wideUnsigned = {0, numeric_limits<uint64_t>::max()};
+    for (int i = 0; i < 1000; ++i) {
+        wideSigned.push_back(static_cast<int64_t>(gen64()));
+        wideUnsigned.push_back(gen64() % 8);
+    }
+    integerSort(wideSigned);
+    checkSorted("Integer Sort (full int64 range)", ranges::is_sorted(wideSigned));
+    integerSort(wideUnsigned);
+    checkSorted("Integer Sort (full uint64 range)", ranges::is_sorted(wideUnsigned));
+
+    writeReports(results, config);
+    if (!passed) {
+        cerr << "Some checks FAILED" << endl;
+        return 1;
+    }
     return 0;
 }
@@ -6,28 +6,28 @@
 #include <chrono>
 #include <random>
 #include <algorithm>
+#include <functional>
+#include <iterator>
+#include "Lab4_Benchmark.h"
+#include "Lab4_Generators.h"
+#include "Lab4_PoolList.h"
+#include "Lab4_SortableAdapters.h"
 
 using namespace std;
 
 // Function to generate a list of random integers
 vector<int> generateRandomList(int size, int min = 1, int max = 1000) {
-    vector<int> list(size);
-    random_device rd;
-    mt19937 gen(rd());
-    uniform_int_distribution<> dist(min, max);
-    for (int& num : list) {
-        num = dist(gen);
-    }
-    return list;
+    return generateList(Distribution::Uniform, size, min, max);
 }
 
-// Selection Sort for list
-template <typename T>
-void selectionSortList(list<T>& lst) {
-    for (auto it = lst.begin(); it != lst.end(); ++it) {
-        auto minIt = it;
-        for (auto jt = next(it); jt != lst.end(); ++jt) {
-            if (*jt < *minIt) {
+// Selection Sort of [first, last) by `comp`; it only walks forward, so it also sorts a list
+template <typename It, typename Compare = less<>>
+    requires forward_iterator<It>
+void selectionSortList(It first, It last, Compare comp = {}) {
+    for (It it = first; it != last; ++it) {
+        It minIt = it;
+        for (It jt = next(it); jt != last; ++jt) {
+            if (comp(*jt, *minIt)) {
                 minIt = jt;
             }
         }
@@ -35,87 +35,136 @@ void selectionSortList(list<T>& lst) {
     }
 }
 
-// Helper function to convert queue to vector for sorting
+template <typename T>
+void selectionSortList(list<T>& lst) {
+    selectionSortList(lst.begin(), lst.end());
+}
+
+// Helper function to convert queue to vector for sorting; `q` is a copy, so its elements are moved
 template <typename T>
 vector<T> queueToVector(queue<T> q) {
     vector<T> vec;
     while (!q.empty()) {
-        vec.push_back(q.front());
+        vec.push_back(move(q.front()));
         q.pop();
     }
     return vec;
 }
 
-// Helper function to convert stack to vector for sorting
+// Helper function to convert stack to vector for sorting; `s` is a copy, so its elements are moved
 template <typename T>
 vector<T> stackToVector(stack<T> s) {
     vector<T> vec;
     while (!s.empty()) {
-        vec.push_back(s.top());
+        vec.push_back(move(s.top()));
         s.pop();
     }
     return vec;
 }
 
-// Function to sort and measure time for Linked List
-template <typename T>
-double measureLinkedListSort(list<T>& lst) {
-    auto start = chrono::high_resolution_clock::now();
-    lst.sort(); // using the built-in sort function for linked list
-    auto end = chrono::high_resolution_clock::now();
-    chrono::duration<double> duration = end - start;
-    return duration.count();
-}
-
-// Function to sort and measure time for Queue
-template <typename T>
-double measureQueueSort(queue<T> q) {
-    auto vec = queueToVector(q);
-    auto start = chrono::high_resolution_clock::now();
-    sort(vec.begin(), vec.end());
-    auto end = chrono::high_resolution_clock::now();
-    chrono::duration<double> duration = end - start;
-    return duration.count();
-}
-
-// Function to sort and measure time for Stack
-template <typename T>
-double measureStackSort(stack<T> s) {
-    auto vec = stackToVector(s);
-    auto start = chrono::high_resolution_clock::now();
-    sort(vec.begin(), vec.end());
-    auto end = chrono::high_resolution_clock::now();
-    chrono::duration<double> duration = end - start;
-    return duration.count();
-}
+int main(int argc, char* argv[]) {
+    BenchmarkConfig config = parseBenchmarkArgs(argc, argv);
+    vector<BenchmarkResult> results;
 
-int main() {
     vector<int> sizes = { 100, 1000, 10000 }; // Different sizes for testing
     for (int size : sizes) {
         auto originalList = generateRandomList(size);
         
-        // Test with Linked List
+        // Test with Linked List, using the built-in sort function for linked list
         list<int> linkedList(originalList.begin(), originalList.end());
-        double linkedListTime = measureLinkedListSort(linkedList);
-        cout << "Linked List Sort (size " << size << ") took " << linkedListTime << " seconds."<<endl;
+        recordBenchmark(results, "Linked List Sort", [](list<int>& lst) { lst.sort(); }, linkedList, config);
 
-        // Test with Queue
+        // Same keys in a list whose nodes come from a slab pool
+        PoolList<int> poolList(originalList.begin(), originalList.end());
+        recordBenchmark(results, "Pool List Sort", [](PoolList<int>& lst) { lst.sort(); }, poolList, config);
+
+        // Test with Queue; the conversion to a vector is not part of the timing
         queue<int> q;
         for (int num : originalList) {
             q.push(num);
         }
-        double queueTime = measureQueueSort(q);
-        cout << "Queue Sort (size " << size << ") took " << queueTime << " seconds."<<endl;
+        recordBenchmark(results, "Queue Sort", [](vector<int>& vec) { sort(vec.begin(), vec.end()); }, queueToVector(q), config);
+
+        // The whole round trip a std::queue needs: pop into a vector, sort, push back
+        recordBenchmark(results, "Queue Round-Trip Sort", [](queue<int>& q) {
+            auto vec = queueToVector(move(q));
+            sort(vec.begin(), vec.end());
+            for (int& num : vec) q.push(move(num));
+        }, q, config);
 
-        // Test with Stack
+        // A ring-buffer queue sorted where it stands, then drained in order; std::sort first,
+        // to compare with the rows above, then the adaptive sort the adapter uses by default
+        SortableQueue<int> sortableQueue;
+        for (int num : originalList) {
+            sortableQueue.push(num);
+        }
+        recordBenchmark(results, "Sortable Queue Sort", [](SortableQueue<int>& q) {
+            auto contents = q.contents();
+            sort(contents.begin(), contents.end());
+        }, sortableQueue, config);
+        recordBenchmark(results, "Sortable Queue Sort + Drain", [](SortableQueue<int>& q) {
+            long long sum = 0;
+            auto contents = q.contents();
+            sort(contents.begin(), contents.end());
+            q.drain([&sum](int&& num) { sum += num; });
+            q.push(static_cast<int>(sum));
+        }, sortableQueue, config);
+        recordBenchmark(results, "Sortable Queue Adaptive Sort", [](SortableQueue<int>& q) { q.sort(); }, sortableQueue,
+                        config);
+        recordBenchmark(results, "Sortable Queue Priority Drain (10 smallest)", [](SortableQueue<int>& q) {
+            long long sum = 0;
+            q.drainSorted([&sum](int&& num) { sum += num; }, less<>(), 10);
+            q.push(static_cast<int>(sum));
+        }, sortableQueue, config);
+
+        // Test with Stack; the conversion to a vector is not part of the timing
         stack<int> s;
         for (int num : originalList) {
             s.push(num);
         }
-        double stackTime = measureStackSort(s);
-        cout << "Stack Sort (size " << size << ") took " << stackTime << " seconds."<<endl;
+        recordBenchmark(results, "Stack Sort", [](vector<int>& vec) { sort(vec.begin(), vec.end()); }, stackToVector(s), config);
+
+        recordBenchmark(results, "Stack Round-Trip Sort", [](stack<int>& s) {
+            auto vec = stackToVector(move(s));
+            sort(vec.begin(), vec.end(), greater<>());
+            for (int& num : vec) s.push(move(num));
+        }, s, config);
+
+        // A vector-backed stack sorted where it stands
+        SortableStack<int> sortableStack;
+        for (int num : originalList) {
+            sortableStack.push(num);
+        }
+        recordBenchmark(results, "Sortable Stack Sort", [](SortableStack<int>& s) {
+            auto contents = s.contents();
+            sort(contents.begin(), contents.end(), greater<>());
+        }, sortableStack, config);
+        recordBenchmark(results, "Sortable Stack Adaptive Sort", [](SortableStack<int>& s) { s.sort(); }, sortableStack,
+                        config);
 
         cout << "----------------------------------------" << endl;
     }
+
+    // Large lists, where the nodes no longer fit in cache: std::list against every PoolList
+    // sort mode. Sorting 10^7 nodes takes seconds, so these runs use fewer repetitions.
+    BenchmarkConfig largeConfig = config;
+    largeConfig.warmup = min(config.warmup, 1);
+    largeConfig.repetitions = min(config.repetitions, 3);
+    for (int size : {100000, 1000000, 10000000}) {
+        auto originalList = generateList(Distribution::Uniform, size, 0, 1000000000);
+        {
+            list<int> linkedList(originalList.begin(), originalList.end());
+            recordBenchmark(results, "Linked List Sort", [](list<int>& lst) { lst.sort(); }, linkedList, largeConfig,
+                            "linked list");
+        }
+        PoolList<int> poolList(originalList.begin(), originalList.end());
+        for (ListSortMode mode : {ListSortMode::Merge, ListSortMode::Prefetch, ListSortMode::Gather}) {
+            recordBenchmark(results, "Pool List Sort (" + listSortModeName(mode) + ")", [mode](PoolList<int>& lst) {
+                lst.sort(less<>(), mode);
+            }, poolList, largeConfig, "linked list");
+        }
+        cout << "----------------------------------------" << endl;
+    }
+    writeReports(results, config);
     return 0;
 }
@@ -2,91 +2,93 @@
 #include <vector>
 #include <chrono>
 #include <random>
+#include <algorithm>
+#include <string>
+#include "Lab4_Benchmark.h"
+#include "Lab4_Generators.h"
+#include "Lab4_InsertionSort.h"
+#include "Lab4_SortingNetwork.h"
 
 using namespace std;
 
 // Function to generate a list of random integers
 vector<int> generateRandomList(int size, int min = 1, int max = 1000) {
-    vector<int> list(size);
-    random_device rd;
-    mt19937 gen(rd());
-    uniform_int_distribution<> dist(min, max);
-    for (int& num : list) {
-        num = dist(gen);
-    }
-    return list;
-}
-
-// Standard Insertion Sort
-template <typename T>
-void insertionSort(vector<T>& arr) {
-    int n = arr.size();
-    for (int i = 1; i < n; ++i) {
-        T key = arr[i];
-        int j = i - 1;
-        while (j >= 0 && arr[j] > key) {
-            arr[j + 1] = arr[j];
-            --j;
-        }
-        arr[j + 1] = key;
-    }
+    return generateList(Distribution::Uniform, size, min, max);
 }
 
-// Binary Search to find the insertion position
-template <typename T>
-int binarySearch(const vector<T>& arr, int start, int end, const T& key) {
-    while (start <= end) {
-        int mid = start + (end - start) / 2;
-        if (arr[mid] == key) return mid;
-        else if (arr[mid] < key) start = mid + 1;
-        else end = mid - 1;
-    }
-    return start; // Return the position where key should be inserted
-}
+// Standard Insertion Sort is the iterator one of Lab4_InsertionSort.h, with a linear search for the slot
 
-// Insertion Sort using Binary Search
-template <typename T>
-void binaryInsertionSort(vector<T>& arr) {
-    int n = arr.size();
-    for (int i = 1; i < n; ++i) {
-        T key = arr[i];
-        int pos = binarySearch(arr, 0, i - 1, key);
-
-        
-        for (int j = i - 1; j >= pos; --j) {
-            arr[j + 1] = arr[j];
-        }
-        arr[pos] = key;
-    }
+// Long keys with a shared prefix, where a comparison costs more than a move
+vector<string> generateUrlList(int size) {
+    auto keys = generateList(Distribution::Uniform, size, 1, 1000000000);
+    vector<string> list(size);
+    for (int i = 0; i < size; ++i) list[i] = "https://example.com/catalog/item-" + to_string(keys[i]);
+    return list;
 }
 
-// Helper function to measure execution time
-template <typename Func, typename T>
-double measureTime(Func func, vector<T> arr) {
-    auto start = chrono::high_resolution_clock::now();
-    func(arr);
-    auto end = chrono::high_resolution_clock::now();
-    chrono::duration<double> duration = end - start;
-    return duration.count();
-}
+int main(int argc, char* argv[]) {
+    BenchmarkConfig config = parseBenchmarkArgs(argc, argv);
+    vector<BenchmarkResult> results;
 
-int main() {
     vector<int> sizes = {100, 1000, 10000}; // Array sizes for testing
     for (int size : sizes) {
-        auto originalList = generateRandomList(size);
+        for (Distribution dist : allDistributions()) {
+            auto originalList = generateList(dist, size);
+            string name = distributionName(dist);
+            cout << "Distribution: " << name << endl;
 
-        // Measure time for standard Insertion Sort
-        auto standardInsertionSortList = originalList;
-        double standardTime = measureTime(insertionSort<int>, standardInsertionSortList);
-        cout << "Standard Insertion Sort (size " << size << ") took " << standardTime << " seconds for the process."<<endl;
+            // Measure time for standard Insertion Sort
+            recordBenchmark(results, "Standard Insertion Sort", [](vector<int>& arr) { insertionSort(arr.begin(), arr.end()); },
+                            originalList, config, name);
 
-        // Measure time for Binary Insertion Sort
-        auto binaryInsertionSortList = originalList;
-        double binaryTime = measureTime(binaryInsertionSort<int>, binaryInsertionSortList);
-        cout << "Binary Insertion Sort (size " << size << ") took " << binaryTime << " seconds for the process."<<endl;
+            // Measure time for Binary Insertion Sort with each search
+            for (InsertionSearch search : {InsertionSearch::Auto, InsertionSearch::Branchless, InsertionSearch::Gallop}) {
+                recordBenchmark(results, "Binary Insertion Sort (" + insertionSearchName(search) + ")",
+                                [search](vector<int>& arr) {
+                                    binaryInsertionSort(arr.begin(), arr.end(), less<>(), search);
+                                }, originalList, config, name);
+            }
+        }
 
         cout << "----------------------------------------" << endl;
     }
 
+    // Strings: binary insertion makes about n log n comparisons against n^2 / 4
+    for (int size : {100, 1000}) {
+        auto urlList = generateUrlList(size);
+        string name = "urls, size " + to_string(size);
+        cout << "URL strings: " << size << endl;
+        recordBenchmark(results, "Standard Insertion Sort", [](vector<string>& arr) { insertionSort(arr.begin(), arr.end()); },
+                        urlList, config, name);
+        recordBenchmark(results, "Binary Insertion Sort (auto)", [](vector<string>& arr) {
+            binaryInsertionSort(arr.begin(), arr.end());
+        }, urlList, config, name);
+    }
+    cout << "----------------------------------------" << endl;
+
+    // Small blocks as sorted by the hybrid sorts' base case: 10000 independent blocks per run
+    cout << "SIMD level: " << simdLevelName(simdLevel()) << endl;
+    for (int block : {8, 16, 32, 64}) {
+        auto originalList = generateRandomList(block * 10000, 1, 1000000);
+        vector<double> doubleList(originalList.begin(), originalList.end());
+        string name = "blocks of " + to_string(block);
+        cout << "Block size: " << block << endl;
+
+        recordBenchmark(results, "Insertion Sort (int blocks)", [block](vector<int>& arr) {
+            for (int i = 0; i < static_cast<int>(arr.size()); i += block) insertionSort(arr, i, i + block - 1);
+        }, originalList, config, name);
+        recordBenchmark(results, "Sorting Network (int blocks)", [block](vector<int>& arr) {
+            for (int i = 0; i < static_cast<int>(arr.size()); i += block) networkSort(&arr[i], block);
+        }, originalList, config, name);
+        recordBenchmark(results, "Insertion Sort (double blocks)", [block](vector<double>& arr) {
+            for (int i = 0; i < static_cast<int>(arr.size()); i += block) insertionSort(arr, i, i + block - 1);
+        }, doubleList, config, name);
+        recordBenchmark(results, "Sorting Network (double blocks)", [block](vector<double>& arr) {
+            for (int i = 0; i < static_cast<int>(arr.size()); i += block) networkSort(&arr[i], block);
+        }, doubleList, config, name);
+    }
+    cout << "----------------------------------------" << endl;
+
+    writeReports(results, config);
     return 0;
 }
@@ -2,69 +2,199 @@
 #include <vector>
 #include <random>
 #include <algorithm>
+#include <limits>
+#include <queue>
+#include <span>
+#include "Lab4_Benchmark.h"
+#include "Lab4_Generators.h"
+#include "Lab4_Heap.h"
 
 using namespace std;
 
 // Function to generate a list of random integers
 vector<int> generateRandomList(int size, int min = 1, int max = 1000) {
-    vector<int> list(size);
-    random_device rd;
-    mt19937 gen(rd());
-    uniform_int_distribution<> dist(min, max);
-    for (int& num : list) {
-        num = dist(gen);
-    }
-    return list;
+    return generateList(Distribution::Uniform, size, min, max);
 }
 
-// Function to heapify a subtree with the root at index `i`
-// `n` is the size of the heap
-void heapify(vector<int>& arr, int n, int i) {
-    int largest = i;       // Initialize largest as root
-    int left = 2 * i + 1;  // Left child
-    int right = 2 * i + 2; // Right child
+// Function to find the maximum value using a heap: a top-1 selector keeps a heap of one
+// element, so this is a single pass that leaves the caller's data untouched. An empty
+// array has no maximum and gives numeric_limits<int>::min(), the identity of max.
+int findMaxWithHeapSort(const vector<int>& arr) {
+    if (arr.empty()) return numeric_limits<int>::min();
+    return topK(arr.begin(), arr.end(), 1).front();
+}
 
-    // If left child is larger than root
-    if (left < n && arr[left] > arr[largest]) {
-        largest = left;
-    }
+// Random directed graph in adjacency-array form: the edges of node v are
+// targets[offsets[v] .. offsets[v + 1]) with the matching weights
+struct Graph {
+    vector<int> offsets;
+    vector<int> targets;
+    vector<int> weights;
+};
 
-    // If right child is larger than largest so far
-    if (right < n && arr[right] > arr[largest]) {
-        largest = right;
+Graph randomGraph(int nodes, int degree, unsigned seed = defaultSeed) {
+    mt19937 gen(seed);
+    uniform_int_distribution<> node(0, nodes - 1);
+    uniform_int_distribution<> weight(1, 1000);
+    Graph graph;
+    for (int v = 0; v <= nodes; ++v) graph.offsets.push_back(v * degree);
+    for (int e = 0; e < nodes * degree; ++e) {
+        graph.targets.push_back(node(gen));
+        graph.weights.push_back(weight(gen));
     }
+    return graph;
+}
+
+const long long unreachable = -1;
 
-    // If largest is not root, swap and heapify the affected subtree
-    if (largest != i) {
-        swap(arr[i], arr[largest]);
-        heapify(arr, n, largest); // Recursively heapify the affected subtree
+// Dijkstra's shortest paths with an addressable heap: every node is queued once and its
+// entry is moved up in place when a shorter path is found
+template <int Arity>
+vector<long long> dijkstraDecreaseKey(const Graph& graph, int source) {
+    int nodes = graph.offsets.size() - 1;
+    vector<long long> dist(nodes, unreachable);
+    vector<size_t> handle(nodes);
+    vector<char> done(nodes, 0);
+    PriorityQueue<pair<long long, int>, less<>, Arity> queue;
+    dist[source] = 0;
+    handle[source] = queue.push({0, source});
+    while (!queue.empty()) {
+        auto [d, v] = queue.pop();
+        done[v] = 1;
+        for (int e = graph.offsets[v]; e < graph.offsets[v + 1]; ++e) {
+            int u = graph.targets[e];
+            long long candidate = d + graph.weights[e];
+            if (done[u]) continue;
+            if (dist[u] == unreachable) {
+                dist[u] = candidate;
+                handle[u] = queue.push({candidate, u});
+            } else if (candidate < dist[u]) {
+                dist[u] = candidate;
+                queue.decreaseKey(handle[u], {candidate, u});
+            }
+        }
     }
+    return dist;
 }
 
-// Function to build a Max-Heap from the array
-void buildMaxHeap(vector<int>& arr) {
-    int n = arr.size();
-    // Start from the last non-leaf node and heapify each node
-    for (int i = n / 2 - 1; i >= 0; --i) {
-        heapify(arr, n, i);
+// Dijkstra's shortest paths with std::priority_queue, which has no decrease-key: every
+// improvement pushes a new entry and outdated entries are skipped when they come out
+vector<long long> dijkstraLazy(const Graph& graph, int source) {
+    int nodes = graph.offsets.size() - 1;
+    vector<long long> dist(nodes, unreachable);
+    priority_queue<pair<long long, int>, vector<pair<long long, int>>, greater<>> queue;
+    dist[source] = 0;
+    queue.push({0, source});
+    while (!queue.empty()) {
+        auto [d, v] = queue.top();
+        queue.pop();
+        if (d != dist[v]) continue;
+        for (int e = graph.offsets[v]; e < graph.offsets[v + 1]; ++e) {
+            int u = graph.targets[e];
+            long long candidate = d + graph.weights[e];
+            if (dist[u] == unreachable || candidate < dist[u]) {
+                dist[u] = candidate;
+                queue.push({candidate, u});
+            }
+        }
     }
+    return dist;
 }
 
-// Function to find the maximum value using Max-Heap
-int findMaxWithHeapSort(vector<int>& arr) {
-    // Build a Max-Heap
-    buildMaxHeap(arr);
-    // The maximum value will be at the root of the heap
-    return arr[0];
-}
+int main(int argc, char* argv[]) {
+    BenchmarkConfig config = parseBenchmarkArgs(argc, argv);
+    vector<BenchmarkResult> results;
 
-int main() {
     int size = 10;  // Bạn có thể thay đổi kích thước của mảng ở đây
     auto arr = generateRandomList(size);
 
-    // Find maximum using Heap Sort (Max-Heap)
+    // Find maximum using a Max-Heap
     int maxVal = findMaxWithHeapSort(arr);
     cout << "The maximum value is: " << maxVal << endl;
+    cout << "----------------------------------------" << endl;
+
+    // Heap Sort through binary, 4-ary and 8-ary heaps
+    for (int size : {10000, 1000000}) {
+        auto originalList = generateList(Distribution::Uniform, size, 0, 1000000000);
+        recordBenchmark(results, "Heap Sort (binary)", [](vector<int>& arr) {
+            heapSort<2>(arr.begin(), arr.end());
+        }, originalList, config, "heap sort");
+        recordBenchmark(results, "Heap Sort (4-ary)", [](vector<int>& arr) {
+            heapSort<4>(arr.begin(), arr.end());
+        }, originalList, config, "heap sort");
+        recordBenchmark(results, "Heap Sort (8-ary)", [](vector<int>& arr) {
+            heapSort<8>(arr.begin(), arr.end());
+        }, originalList, config, "heap sort");
+        recordBenchmark(results, "std::make_heap + std::sort_heap", [](vector<int>& arr) {
+            make_heap(arr.begin(), arr.end());
+            sort_heap(arr.begin(), arr.end());
+        }, originalList, config, "heap sort");
+
+        // Floyd's construction against inserting the elements one at a time
+        recordBenchmark(results, "Floyd Heap Construction (binary)", [](vector<int>& arr) {
+            buildMaxHeap<2>(arr.begin(), arr.end());
+        }, originalList, config, "heap construction");
+        recordBenchmark(results, "Floyd Heap Construction (4-ary)", [](vector<int>& arr) {
+            buildMaxHeap<4>(arr.begin(), arr.end());
+        }, originalList, config, "heap construction");
+        recordBenchmark(results, "Repeated Push Construction", [](vector<int>& arr) {
+            for (auto it = arr.begin(); it != arr.end(); ++it) push_heap(arr.begin(), it + 1);
+        }, originalList, config, "heap construction");
+        cout << "----------------------------------------" << endl;
+    }
+
+    // Top-k of a stream: the events arrive in batches and only k values are ever kept.
+    // The std baselines either keep the whole input (nth_element, partial_sort) or a
+    // std::priority_queue without the one-comparison rejection of the selector.
+    const size_t batchSize = 1 << 16;
+    auto events = generateList(Distribution::Uniform, 4000000, 0, 1000000000);
+    for (size_t k : {10, 1000, 100000}) {
+        string suffix = " (k = " + to_string(k) + ")";
+        recordBenchmark(results, "Top-K Selector" + suffix, [k, batchSize](vector<int>& arr) {
+            TopK<int> selector(k);
+            span<const int> stream(arr);
+            for (size_t i = 0; i < stream.size(); i += batchSize) {
+                selector.pushBatch(stream.subspan(i, min(batchSize, stream.size() - i)));
+            }
+            auto best = selector.sorted();
+            copy(best.begin(), best.end(), arr.begin());
+        }, events, config, "top-k");
+        recordBenchmark(results, "std::priority_queue" + suffix, [k](vector<int>& arr) {
+            priority_queue<int, vector<int>, greater<>> queue;
+            for (int value : arr) {
+                if (queue.size() < k) {
+                    queue.push(value);
+                } else if (queue.top() < value) {
+                    queue.pop();
+                    queue.push(value);
+                }
+            }
+            for (size_t i = queue.size(); i-- > 0; queue.pop()) arr[i] = queue.top();
+        }, events, config, "top-k");
+        recordBenchmark(results, "std::nth_element" + suffix, [k](vector<int>& arr) {
+            nth_element(arr.begin(), arr.begin() + k, arr.end(), greater<>());
+            sort(arr.begin(), arr.begin() + k, greater<>());
+        }, events, config, "top-k");
+        recordBenchmark(results, "std::partial_sort" + suffix, [k](vector<int>& arr) {
+            partial_sort(arr.begin(), arr.begin() + k, arr.end(), greater<>());
+        }, events, config, "top-k");
+    }
+    cout << "----------------------------------------" << endl;
+
+    // Shortest paths on a random sparse graph: decrease-key against lazy re-insertion
+    Graph graph = randomGraph(200000, 8);
+    bool match = dijkstraDecreaseKey<4>(graph, 0) == dijkstraLazy(graph, 0);
+    cout << "Dijkstra distances " << (match ? "match" : "DIFFER") << " between the queues" << endl;
+    recordBenchmark(results, "Dijkstra (binary decrease-key)", [&graph](vector<int>& arr) {
+        arr[0] = dijkstraDecreaseKey<2>(graph, 0).back();
+    }, graph.targets, config, "dijkstra");
+    recordBenchmark(results, "Dijkstra (4-ary decrease-key)", [&graph](vector<int>& arr) {
+        arr[0] = dijkstraDecreaseKey<4>(graph, 0).back();
+    }, graph.targets, config, "dijkstra");
+    recordBenchmark(results, "Dijkstra (std::priority_queue)", [&graph](vector<int>& arr) {
+        arr[0] = dijkstraLazy(graph, 0).back();
+    }, graph.targets, config, "dijkstra");
 
+    writeReports(results, config);
     return 0;
 }
@@ -3,109 +3,242 @@
 #include <chrono>
 #include <random>
 #include <algorithm>
+#include <functional>
+#include <iterator>
+#include <cstdio>
+#include <filesystem>
+#include <span>
+#include "Lab4_Benchmark.h"
+#include "Lab4_ExternalSort.h"
+#include "Lab4_Generators.h"
+#include "Lab4_MappedFile.h"
+#include "Lab4_InsertionSort.h"
+#include "Lab4_MergeSort.h"
+#include "Lab4_Parallel.h"
+#include "Lab4_SortingNetwork.h"
+#include "Lab4_Tuning.h"
 
 using namespace std;
 
 // Function to generate a list of random integers
 vector<int> generateRandomList(int size, int min = 1, int max = 1000) {
-    vector<int> list(size);
-    random_device rd;
-    mt19937 gen(rd());
-    uniform_int_distribution<> dist(min, max);
-    for (int& num : list) {
-        num = dist(gen);
-    }
-    return list;
+    return generateList(Distribution::Uniform, size, min, max);
 }
 
-// Insertion Sort for small arrays
-template <typename T>
-void insertionSort(vector<T>& arr, int left, int right) {
-    for (int i = left + 1; i <= right; ++i) {
-        T key = arr[i];
-        int j = i - 1;
-        while (j >= left && arr[j] > key) {
-            arr[j + 1] = arr[j];
-            --j;
-        }
-        arr[j + 1] = key;
+// Merge the sorted halves [first, mid) and [mid, last) by `comp`
+template <typename It, typename Compare = less<>>
+    requires random_access_iterator<It>
+void mergeHalves(It first, It mid, It last, Compare comp = {}) {
+    using T = iter_value_t<It>;
+    // Move the halves out instead of copying them
+    vector<T> L(make_move_iterator(first), make_move_iterator(mid));
+    vector<T> R(make_move_iterator(mid), make_move_iterator(last));
+
+    size_t i = 0, j = 0;
+    It k = first;
+    while (i < L.size() && j < R.size()) {
+        if (!comp(R[j], L[i])) *k++ = move(L[i++]);
+        else *k++ = move(R[j++]);
     }
+    while (i < L.size()) *k++ = move(L[i++]);
+    while (j < R.size()) *k++ = move(R[j++]);
 }
 
-// Merge function to merge two halves of the array
-template <typename T>
-void merge(vector<T>& arr, int left, int mid, int right) {
-    int n1 = mid - left + 1;
-    int n2 = right - mid;
-    vector<T> L(n1), R(n2);
-
-    for (int i = 0; i < n1; ++i) L[i] = arr[left + i];
-    for (int j = 0; j < n2; ++j) R[j] = arr[mid + 1 + j];
-
-    int i = 0, j = 0, k = left;
-    while (i < n1 && j < n2) {
-        if (L[i] <= R[j]) arr[k++] = L[i++];
-        else arr[k++] = R[j++];
+// Standard Merge Sort of [first, last) by `comp`
+template <typename It, typename Compare = less<>>
+    requires random_access_iterator<It>
+void mergeSort(It first, It last, Compare comp = {}) {
+    if (last - first > 1) {
+        It mid = first + (last - first) / 2;
+        mergeSort(first, mid, comp);
+        mergeSort(mid, last, comp);
+        mergeHalves(first, mid, last, comp);
     }
-    while (i < n1) arr[k++] = L[i++];
-    while (j < n2) arr[k++] = R[j++];
 }
 
-// Standard Merge Sort
 template <typename T>
 void mergeSort(vector<T>& arr, int left, int right) {
-    if (left < right) {
-        int mid = left + (right - left) / 2;
-        mergeSort(arr, left, mid);
-        mergeSort(arr, mid + 1, right);
-        merge(arr, left, mid, right);
-    }
+    if (left < right) mergeSort(arr.begin() + left, arr.begin() + right + 1);
 }
 
-// Hybrid Sort: Uses Merge Sort for large arrays and Insertion Sort for small subarrays
-template <typename T>
-void hybridSort(vector<T>& arr, int left, int right, int threshold = 10) {
-    if (right - left + 1 <= threshold) {
-        // Use Insertion Sort for small arrays
-        insertionSort(arr, left, right);
+// Hybrid Sort: Uses Merge Sort for large arrays and a sorting network (Insertion Sort
+// for types without one) for small subarrays. The cutoff comes from the threshold profile.
+template <typename It, typename Compare = less<>>
+    requires random_access_iterator<It>
+void hybridSort(It first, It last, Compare comp = {},
+                int threshold = tunedThreshold<iter_value_t<It>>("merge-hybrid")) {
+    if (last - first <= threshold) {
+        // Use a sorting network or Insertion Sort for small arrays
+        smallSort(first, last, comp);
     } else {
         // Use Merge Sort for large arrays
-        int mid = left + (right - left) / 2;
-        hybridSort(arr, left, mid, threshold);
-        hybridSort(arr, mid + 1, right, threshold);
-        merge(arr, left, mid, right);
+        It mid = first + (last - first) / 2;
+        hybridSort(first, mid, comp, threshold);
+        hybridSort(mid, last, comp, threshold);
+        mergeHalves(first, mid, last, comp);
     }
 }
 
-// Helper function to measure execution time
-template <typename Func, typename T>
-double measureTime(Func func, vector<T>& arr) {
-    auto start = chrono::high_resolution_clock::now();
-    func(arr, 0, arr.size() - 1);
-    auto end = chrono::high_resolution_clock::now();
-    chrono::duration<double> duration = end - start;
-    return duration.count();
+template <typename T>
+void hybridSort(vector<T>& arr, int left, int right, int threshold = tunedThreshold<T>("merge-hybrid")) {
+    if (left < right) hybridSort(arr.begin() + left, arr.begin() + right + 1, less<>(), threshold);
+}
+
+// Merge `shards` equal sorted slices of arr the way a two-way merge has to: in
+// log2(shards) passes, each merging neighbouring slices between arr and buffer
+void pairwiseMerge(vector<int>& arr, int shards, vector<int>& buffer) {
+    buffer.resize(arr.size());
+    vector<size_t> bounds;
+    for (int s = 0; s <= shards; ++s) bounds.push_back(arr.size() * s / shards);
+    while (bounds.size() > 2) {
+        vector<size_t> merged;
+        for (size_t i = 0; i + 1 < bounds.size(); i += 2) {
+            merged.push_back(bounds[i]);
+            size_t mid = bounds[i + 1], end = i + 2 < bounds.size() ? bounds[i + 2] : mid;
+            moveMerge(arr.begin() + bounds[i], arr.begin() + mid, arr.begin() + mid, arr.begin() + end,
+                      buffer.begin() + bounds[i], less<>());
+        }
+        merged.push_back(arr.size());
+        arr.swap(buffer);
+        bounds = merged;
+    }
+}
+
+// Write `megabytes` of uniform random ints to a binary file, one block of keys at a time,
+// so the data never has to fit in memory
+bool writeRandomFile(const string& path, int megabytes) {
+    const int blockKeys = 1 << 18;  // 1 MB of ints
+    RunWriter<int> writer(path, blockKeys);
+    if (!writer.isOpen()) {
+        cerr << "Cannot open " << path << " for writing" << endl;
+        return false;
+    }
+    for (int block = 0; block < megabytes; ++block) {
+        auto keys = generateList(Distribution::Uniform, blockKeys, 0, 1000000000, defaultSeed + block);
+        writer.write(keys.data(), keys.size());
+    }
+    return writer.close();
 }
 
-int main() {
+int main(int argc, char* argv[]) {
+    BenchmarkConfig config = parseBenchmarkArgs(argc, argv);
+    loadThresholdProfile(config.profilePath);
+    if (!config.inputPath.empty()) {
+        // File mode: sort a binary dump (Buffered Merge Sort unless --sort names another engine)
+        vector<BenchmarkResult> results;
+        bool sorted = sortFile(config, "merge", results);
+        writeReports(results, config);
+        return sorted ? 0 : 1;
+    }
+    if (config.calibrate) {
+        // Sweep the Hybrid Sort cutoff per key type and keep the fastest
+        calibrateThreshold<int>("merge-hybrid", [](vector<int>& arr, int threshold) {
+            hybridSort(arr, 0, arr.size() - 1, threshold);
+        });
+        calibrateThreshold<double>("merge-hybrid", [](vector<double>& arr, int threshold) {
+            hybridSort(arr, 0, arr.size() - 1, threshold);
+        });
+        calibrateThreshold<string>("merge-hybrid", [](vector<string>& arr, int threshold) {
+            hybridSort(arr, 0, arr.size() - 1, threshold);
+        });
+        saveThresholdProfile(config.profilePath);
+    }
+    vector<BenchmarkResult> results;
+
     vector<int> sizes = {100, 1000, 10000};  // Array sizes for testing
+    vector<int> buffer;  // scratch space reused by the buffered sorts
     for (int size : sizes) {
-        auto originalList = generateRandomList(size);
+        for (Distribution dist : allDistributions()) {
+            auto originalList = generateList(dist, size);
+            string name = distributionName(dist);
+            cout << "Distribution: " << name << endl;
 
-        // Measure time for standard Merge Sort
-        auto mergeSortList = originalList;
-        double mergeSortTime = measureTime(mergeSort<int>, mergeSortList);
-        cout << "Standard Merge Sort (size " << size << ") took " << mergeSortTime << " seconds for the process." <<endl;
+            // Measure time for standard Merge Sort
+            recordBenchmark(results, "Standard Merge Sort", [](vector<int>& arr) {
+                mergeSort(arr, 0, arr.size() - 1);
+            }, originalList, config, name);
 
-        // Measure time for Hybrid Sort
-        auto hybridSortList = originalList;
-        double hybridSortTime = measureTime([&](vector<int>& arr, int left, int right) {
-            hybridSort(arr, left, right, 10);  // Threshold of 10 for Insertion Sort
-        }, hybridSortList);
-        cout << "Hybrid Sort (size " << size << ") took " << hybridSortTime << " seconds for the process." <<endl;
+            // Measure time for Hybrid Sort
+            recordBenchmark(results, "Hybrid Sort", [](vector<int>& arr) {
+                hybridSort(arr, 0, arr.size() - 1);  // Cutoff from the threshold profile
+            }, originalList, config, name);
+
+            // Same sorts with one reused scratch buffer instead of per-merge allocations
+            recordBenchmark(results, "Buffered Merge Sort", [&buffer](vector<int>& arr) {
+                bufferedMergeSort(arr, 0, arr.size() - 1, buffer);
+            }, originalList, config, name);
+            recordBenchmark(results, "Buffered Hybrid Sort", [&buffer](vector<int>& arr) {
+                bufferedMergeSort(arr, 0, arr.size() - 1, buffer, 10);
+            }, originalList, config, name);
+
+            // Measure time for the run-detecting, non-recursive Natural Merge Sort
+            recordBenchmark(results, "Natural Merge Sort", [&buffer](vector<int>& arr) {
+                naturalMergeSort(arr, 0, arr.size() - 1, buffer);
+            }, originalList, config, name);
+        }
 
         cout << "----------------------------------------" << endl;
     }
 
+    // Thread scaling of the parallel Hybrid Sort on a large input
+    auto largeList = generateList(Distribution::Uniform, 1000000);
+    for (int threads : threadCounts(config.threads)) {
+        ThreadPool pool(threads);
+        recordBenchmark(results, "Parallel Hybrid Sort (" + to_string(threads) + " threads)", [&](vector<int>& arr) {
+            parallelMergeSort(arr, 0, arr.size() - 1, pool, buffer);
+        }, largeList, config, "uniform");
+        recordBenchmark(results, "Parallel K-Way Merge Sort (" + to_string(threads) + " threads)", [&](vector<int>& arr) {
+            parallelKWayMergeSort(arr, 0, arr.size() - 1, pool, buffer);
+        }, largeList, config, "uniform");
+    }
+
+    // Combining sorted shards: one k-way pass against log2(k) two-way passes, on distinct
+    // keys where every merge decision is a coin flip
+    auto distinctList = generateList(Distribution::Uniform, 1000000, 0, 1000000000);
+    for (int shards : {2, 4, 8, 16, 64}) {
+        auto shardList = distinctList;
+        for (int s = 0; s < shards; ++s) {
+            sort(shardList.begin() + shardList.size() * s / shards, shardList.begin() + shardList.size() * (s + 1) / shards);
+        }
+        string group = to_string(shards) + " shards";
+        recordBenchmark(results, "K-Way Merge (" + group + ")", [&](vector<int>& arr) {
+            vector<span<int>> runs;
+            for (int s = 0; s < shards; ++s) {
+                runs.emplace_back(arr.data() + arr.size() * s / shards, arr.data() + arr.size() * (s + 1) / shards);
+            }
+            buffer.resize(arr.size());
+            kWayMerge(runs, buffer.begin());
+            arr.swap(buffer);
+        }, shardList, config, group);
+        recordBenchmark(results, "Pairwise Merge (" + group + ")", [&](vector<int>& arr) {
+            pairwiseMerge(arr, shards, buffer);
+        }, shardList, config, group);
+    }
+
+    // External Merge Sort of a file larger than the memory budget, only with --external-mb
+    if (config.externalMB > 0) {
+        ExternalSortConfig external;
+        external.memoryBudget = static_cast<size_t>(config.memoryMB) << 20;
+        external.tempDir = config.tempDir;
+        string dir = config.tempDir.empty() ? filesystem::temp_directory_path().string() : config.tempDir;
+        string inputPath = (filesystem::path(dir) / "lab4-external-input.bin").string();
+        string outputPath = (filesystem::path(dir) / "lab4-external-output.bin").string();
+        if (writeRandomFile(inputPath, config.externalMB)) {
+            ExternalSortStats stats = externalSort<int>(inputPath, outputPath, external);
+            BenchmarkResult result = summarize("External Merge Sort (" + to_string(config.memoryMB) + " MB memory)",
+                                               stats.elements, {stats.seconds()});
+            result.group = "uniform";
+            printResult(result);
+            results.push_back(result);
+            cout << "External Merge Sort: " << stats.runs << " runs, " << stats.mergePasses << " merge passes, "
+                 << stats.megabytesPerSecond() << " MB/s (run generation " << stats.runSeconds << " s, merge "
+                 << stats.mergeSeconds << " s), " << (stats.ok && isSortedFile<int>(outputPath) ? "sorted" : "NOT SORTED")
+                 << endl;
+        }
+        remove(inputPath.c_str());
+        remove(outputPath.c_str());
+    }
+
+    writeReports(results, config);
     return 0;
 }
@@ -2,104 +2,244 @@
 #include <vector>
 #include <chrono>
 #include <random>
+#include <algorithm>
+#include <functional>
+#include <iterator>
+#include "Lab4_Benchmark.h"
+#include "Lab4_Generators.h"
+#include "Lab4_MappedFile.h"
+#include "Lab4_IntroSort.h"
+#include "Lab4_Partition.h"
+#include "Lab4_Parallel.h"
+#include "Lab4_Select.h"
+#include "Lab4_SortingNetwork.h"
+#include "Lab4_Tuning.h"
 
 using namespace std;
 
 // Function to generate a list of random integers
 vector<int> generateRandomList(int size, int min = 1, int max = 1000) {
-    vector<int> list(size);
-    random_device rd;
-    mt19937 gen(rd());
-    uniform_int_distribution<> dist(min, max);
-    for (int& num : list) {
-        num = dist(gen);
-    }
-    return list;
+    return generateList(Distribution::Uniform, size, min, max);
 }
 
-// Insertion Sort for small subarrays
-template <typename T>
-void insertionSort(vector<T>& arr, int left, int right) {
-    for (int i = left + 1; i <= right; ++i) {
-        T key = arr[i];
-        int j = i - 1;
-        while (j >= left && arr[j] > key) {
-            arr[j + 1] = arr[j];
-            --j;
+// Standard Quick Sort of [first, last) by `comp`; the partitions are the engines of Lab4_Partition.h
+template <typename It, typename Compare = less<>>
+    requires random_access_iterator<It>
+void quickSort(It first, It last, Compare comp = {}, PartitionScheme scheme = PartitionScheme::Lomuto) {
+    if (last - first > 1) {
+        if (scheme == PartitionScheme::ThreeWay) {
+            // Keys equal to the pivot are already in place and skip the recursion
+            auto [lt, gt] = threeWayPartition(first, last, comp);
+            quickSort(first, lt, comp, scheme);
+            quickSort(gt, last, comp, scheme);
+        } else {
+            It pivot = twoWayPartition(first, last, scheme, comp);
+            quickSort(first, pivot, comp, scheme);
+            quickSort(pivot + 1, last, comp, scheme);
         }
-        arr[j + 1] = key;
     }
 }
 
-// Partition function for Quick Sort
 template <typename T>
-int partition(vector<T>& arr, int low, int high) {
-    T pivot = arr[high];
-    int i = low - 1;
-    for (int j = low; j < high; ++j) {
-        if (arr[j] <= pivot) {
-            ++i;
-            swap(arr[i], arr[j]);
-        }
-    }
-    swap(arr[i + 1], arr[high]);
-    return i + 1;
+void quickSort(vector<T>& arr, int low, int high, PartitionScheme scheme = PartitionScheme::Lomuto) {
+    if (low < high) quickSort(arr.begin() + low, arr.begin() + high + 1, less<>(), scheme);
 }
 
-// Standard Quick Sort
-template <typename T>
-void quickSort(vector<T>& arr, int low, int high) {
-    if (low < high) {
-        int pi = partition(arr, low, high);
-        quickSort(arr, low, pi - 1);
-        quickSort(arr, pi + 1, high);
+// Hybrid Sort: Uses Quick Sort for large datasets and a sorting network (Insertion Sort
+// for types without one) for small subarrays. The cutoff comes from the threshold profile.
+template <typename It, typename Compare = less<>>
+    requires random_access_iterator<It>
+void hybridSort(It first, It last, Compare comp = {},
+                int threshold = tunedThreshold<iter_value_t<It>>("quick-hybrid"),
+                PartitionScheme scheme = PartitionScheme::Lomuto) {
+    if (last - first <= threshold) {
+        // Use a sorting network or Insertion Sort for small subarrays
+        smallSort(first, last, comp);
+    } else if (scheme == PartitionScheme::ThreeWay) {
+        // Use three-way Quick Sort for large subarrays with many equal keys
+        auto [lt, gt] = threeWayPartition(first, last, comp);
+        hybridSort(first, lt, comp, threshold, scheme);
+        hybridSort(gt, last, comp, threshold, scheme);
+    } else {
+        // Use Quick Sort for large subarrays
+        It pivot = twoWayPartition(first, last, scheme, comp);
+        hybridSort(first, pivot, comp, threshold, scheme);
+        hybridSort(pivot + 1, last, comp, threshold, scheme);
     }
 }
 
-// Hybrid Sort: Uses Quick Sort for large datasets and Insertion Sort for small subarrays
 template <typename T>
-void hybridSort(vector<T>& arr, int low, int high, int threshold = 10) {
-    if (high - low + 1 <= threshold) {
-        // Use Insertion Sort for small subarrays
-        insertionSort(arr, low, high);
+void hybridSort(vector<T>& arr, int low, int high, int threshold = tunedThreshold<T>("quick-hybrid"),
+                PartitionScheme scheme = PartitionScheme::Lomuto) {
+    if (low < high) hybridSort(arr.begin() + low, arr.begin() + high + 1, less<>(), threshold, scheme);
+}
+
+// Throughput and mispredictions per key of a partition benchmark
+void printPartitionRate(const BenchmarkResult& result) {
+    cout << "  " << result.size / result.median / 1e6 << " million keys per second, ";
+    if (result.branchMisses >= 0) {
+        cout << result.branchMisses / result.size << " branch misses per key" << endl;
     } else {
-        // Use Quick Sort for large subarrays
-        int pi = partition(arr, low, high);
-        hybridSort(arr, low, pi - 1, threshold);
-        hybridSort(arr, pi + 1, high, threshold);
+        cout << "branch misses not available (no hardware counters)" << endl;
     }
 }
 
-// Helper function to measure execution time
-template <typename Func, typename T>
-double measureTime(Func func, vector<T>& arr) {
-    auto start = chrono::high_resolution_clock::now();
-    func(arr, 0, arr.size() - 1);
-    auto end = chrono::high_resolution_clock::now();
-    chrono::duration<double> duration = end - start;
-    return duration.count();
-}
+int main(int argc, char* argv[]) {
+    BenchmarkConfig config = parseBenchmarkArgs(argc, argv);
+    loadThresholdProfile(config.profilePath);
+    if (!config.inputPath.empty()) {
+        // File mode: sort a binary dump (Intro Sort unless --sort names another engine)
+        vector<BenchmarkResult> results;
+        bool sorted = sortFile(config, "intro", results);
+        writeReports(results, config);
+        return sorted ? 0 : 1;
+    }
+    if (config.calibrate) {
+        // Sweep the Hybrid Sort cutoff per key type and keep the fastest
+        calibrateThreshold<int>("quick-hybrid", [](vector<int>& arr, int threshold) {
+            hybridSort(arr, 0, arr.size() - 1, threshold);
+        });
+        calibrateThreshold<double>("quick-hybrid", [](vector<double>& arr, int threshold) {
+            hybridSort(arr, 0, arr.size() - 1, threshold);
+        });
+        calibrateThreshold<string>("quick-hybrid", [](vector<string>& arr, int threshold) {
+            hybridSort(arr, 0, arr.size() - 1, threshold);
+        });
+        saveThresholdProfile(config.profilePath);
+    }
+    const int threshold = tunedThreshold<int>("quick-hybrid");
+    vector<BenchmarkResult> results;
 
-int main() {
     vector<int> sizes = {100, 1000, 10000};  // Array sizes for testing
     for (int size : sizes) {
-        auto originalList = generateRandomList(size);
+        for (Distribution dist : allDistributions()) {
+            auto originalList = generateList(dist, size);
+            string name = distributionName(dist);
+            cout << "Distribution: " << name << endl;
+
+            // Measure time for standard Quick Sort
+            recordBenchmark(results, "Standard Quick Sort", [](vector<int>& arr) {
+                quickSort(arr, 0, arr.size() - 1);
+            }, originalList, config, name);
+
+            // Measure time for Hybrid Sort
+            recordBenchmark(results, "Hybrid Sort", [](vector<int>& arr) {
+                hybridSort(arr, 0, arr.size() - 1);  // Cutoff from the threshold profile
+            }, originalList, config, name);
 
-        // Measure time for standard Quick Sort
-        auto quickSortList = originalList;
-        double quickSortTime = measureTime(quickSort<int>, quickSortList);
-        cout << "Standard Quick Sort (size " << size << ") took " << quickSortTime << " seconds for the process." <<endl;
+            // Measure time for Intro Sort with the same small-array cutoff
+            recordBenchmark(results, "Intro Sort", [threshold](vector<int>& arr) {
+                introSort(arr, 0, arr.size() - 1, threshold);
+            }, originalList, config, name);
 
-        // Measure time for Hybrid Sort
-        auto hybridSortList = originalList;
-        double hybridSortTime = measureTime([&](vector<int>& arr, int low, int high) {
-            hybridSort(arr, low, high, 10);  // Threshold of 10 for Insertion Sort
-        }, hybridSortList);
-        cout << "Hybrid Sort (size " << size << ") took " << hybridSortTime << " seconds for the process." <<endl;
+            // Same sorts with three-way partitioning for duplicate-heavy keys
+            recordBenchmark(results, "Three-Way Quick Sort", [](vector<int>& arr) {
+                quickSort(arr, 0, arr.size() - 1, PartitionScheme::ThreeWay);
+            }, originalList, config, name);
+            recordBenchmark(results, "Three-Way Hybrid Sort", [threshold](vector<int>& arr) {
+                hybridSort(arr, 0, arr.size() - 1, threshold, PartitionScheme::ThreeWay);
+            }, originalList, config, name);
+            recordBenchmark(results, "Three-Way Intro Sort", [threshold](vector<int>& arr) {
+                introSort(arr, 0, arr.size() - 1, threshold, PartitionScheme::ThreeWay);
+            }, originalList, config, name);
+
+            // Same sorts with the branchless block and vectorized partition engines
+            recordBenchmark(results, "Block Quick Sort", [](vector<int>& arr) {
+                quickSort(arr, 0, arr.size() - 1, PartitionScheme::Block);
+            }, originalList, config, name);
+            recordBenchmark(results, "Block Hybrid Sort", [threshold](vector<int>& arr) {
+                hybridSort(arr, 0, arr.size() - 1, threshold, PartitionScheme::Block);
+            }, originalList, config, name);
+            recordBenchmark(results, "SIMD Quick Sort", [](vector<int>& arr) {
+                quickSort(arr, 0, arr.size() - 1, PartitionScheme::Simd);
+            }, originalList, config, name);
+            recordBenchmark(results, "SIMD Hybrid Sort", [threshold](vector<int>& arr) {
+                hybridSort(arr, 0, arr.size() - 1, threshold, PartitionScheme::Simd);
+            }, originalList, config, name);
+        }
 
         cout << "----------------------------------------" << endl;
     }
 
+    // One partition pass over a large input around its median, the worst case for a
+    // branchy partition: every comparison is a coin flip
+    BenchmarkConfig partitionConfig = config;
+    partitionConfig.branchMisses = true;
+    auto partitionList = generateList(Distribution::Uniform, 1000000, 0, 1000000000);
+    vector<int> sortedCopy = partitionList;
+    nth_element(sortedCopy.begin(), sortedCopy.begin() + sortedCopy.size() / 2, sortedCopy.end());
+    swap(*find(partitionList.begin(), partitionList.end(), sortedCopy[sortedCopy.size() / 2]), partitionList.back());
+    cout << "Partition engines (SIMD level " << simdLevelName(simdLevel()) << ")" << endl;
+    recordBenchmark(results, "Lomuto Partition", [](vector<int>& arr) {
+        lomutoPartition(arr, 0, arr.size() - 1);
+    }, partitionList, partitionConfig, "partition");
+    printPartitionRate(results.back());
+    recordBenchmark(results, "Block Partition", [](vector<int>& arr) {
+        blockPartition(arr, 0, arr.size() - 1);
+    }, partitionList, partitionConfig, "partition");
+    printPartitionRate(results.back());
+    recordBenchmark(results, "SIMD Partition", [](vector<int>& arr) {
+        simdPartition(arr, 0, arr.size() - 1);
+    }, partitionList, partitionConfig, "partition");
+    printPartitionRate(results.back());
+    cout << "----------------------------------------" << endl;
+
+    // Selection: the median, a set of percentiles and the k smallest keys without a full sort
+    auto selectList = generateList(Distribution::Uniform, 1000000, 0, 1000000000);
+    const long middle = selectList.size() / 2;
+    const vector<double> reportPercentiles = {0.5, 0.9, 0.99, 0.999};
+    vector<long> percentileRanks;
+    for (double p : reportPercentiles) percentileRanks.push_back(static_cast<long>(p * (selectList.size() - 1)));
+    recordBenchmark(results, "std::nth_element (median)", [middle](vector<int>& arr) {
+        nth_element(arr.begin(), arr.begin() + middle, arr.end());
+    }, selectList, config, "selection");
+    recordBenchmark(results, "Intro Select (median)", [middle](vector<int>& arr) {
+        introSelect(arr.begin(), arr.begin() + middle, arr.end(), less<>(), PartitionScheme::Lomuto);
+    }, selectList, config, "selection");
+    recordBenchmark(results, "SIMD Intro Select (median)", [middle](vector<int>& arr) {
+        introSelect(arr.begin(), arr.begin() + middle, arr.end(), less<>(), PartitionScheme::Simd);
+    }, selectList, config, "selection");
+    recordBenchmark(results, "Floyd-Rivest Select (median)", [middle](vector<int>& arr) {
+        floydRivestSelect(arr.begin(), arr.begin() + middle, arr.end(), less<>(), PartitionScheme::Lomuto);
+    }, selectList, config, "selection");
+    recordBenchmark(results, "SIMD Floyd-Rivest Select (median)", [middle](vector<int>& arr) {
+        floydRivestSelect(arr.begin(), arr.begin() + middle, arr.end(), less<>(), PartitionScheme::Simd);
+    }, selectList, config, "selection");
+    recordBenchmark(results, "Multi-Select (4 percentiles)", [&percentileRanks](vector<int>& arr) {
+        multiSelect(arr.begin(), arr.end(), percentileRanks);
+    }, selectList, config, "selection");
+    recordBenchmark(results, "Separate Selects (4 percentiles)", [&percentileRanks](vector<int>& arr) {
+        for (long rank : percentileRanks) nthElement(arr.begin(), arr.begin() + rank, arr.end());
+    }, selectList, config, "selection");
+    for (int k : {100, 10000, 100000}) {
+        recordBenchmark(results, "Partial Sort (k = " + to_string(k) + ")", [k](vector<int>& arr) {
+            partialSort(arr, k);
+        }, selectList, config, "selection");
+        recordBenchmark(results, "std::partial_sort (k = " + to_string(k) + ")", [k](vector<int>& arr) {
+            partial_sort(arr.begin(), arr.begin() + k, arr.end());
+        }, selectList, config, "selection");
+    }
+
+    // A latency report: p50/p90/p99/p99.9 of a million samples, selected instead of sorted
+    vector<double> latencies(selectList.begin(), selectList.end());
+    recordBenchmark(results, "Percentiles by Multi-Select", [&reportPercentiles](vector<double>& samples) {
+        samples[0] = percentiles(samples.begin(), samples.end(), reportPercentiles).back();
+    }, latencies, config, "selection");
+    recordBenchmark(results, "Percentiles by Sorting", [&reportPercentiles](vector<double>& samples) {
+        sort(samples.begin(), samples.end());
+        samples[0] = percentile(samples, reportPercentiles.back());
+    }, latencies, config, "selection");
+    cout << "----------------------------------------" << endl;
+
+    // Thread scaling of the parallel Hybrid Sort on a large input
+    auto largeList = generateList(Distribution::Uniform, 1000000);
+    for (int threads : threadCounts(config.threads)) {
+        ThreadPool pool(threads);
+        recordBenchmark(results, "Parallel Hybrid Sort (" + to_string(threads) + " threads)", [&](vector<int>& arr) {
+            parallelQuickSort(arr, 0, arr.size() - 1, pool);
+        }, largeList, config, "uniform");
+    }
+
+    writeReports(results, config);
     return 0;
 }
-
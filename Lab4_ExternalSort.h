@@ -0,0 +1,317 @@
+#pragma once
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstdio>
+#include <filesystem>
+#include <functional>
+#include <future>
+#include <iostream>
+#include <memory>
+#include <random>
+#include <string>
+#include <system_error>
+#include <type_traits>
+#include <vector>
+#include "Lab4_IntroSort.h"
+#include "Lab4_KWayMerge.h"
+
+// External merge sort of binary files of fixed-size keys (int, int64_t, double, ...) that
+// do not fit in memory: the file is read in memory-budget chunks, each chunk is sorted
+// in place by the hybrid Intro Sort and spilled to a temporary run file, and the runs are
+// merged through a loser tree. Every file is read and written sequentially in large blocks.
+
+// Settings of an external sort
+struct ExternalSortConfig {
+    size_t memoryBudget = size_t(256) << 20;  // bytes for the run buffers and merge buffers
+    std::string tempDir;                      // run files; empty for the system temp directory
+    size_t ioBuffer = size_t(1) << 20;        // bytes per file buffer during the merge
+    size_t maxFanIn = 256;                    // runs merged at once, bounded by the open-file limit
+};
+
+// What an external sort did, all times in seconds
+struct ExternalSortStats {
+    bool ok = false;       // false when a file could not be opened, read or written
+    size_t elements = 0;
+    size_t bytes = 0;
+    size_t runs = 0;       // sorted runs spilled by run generation
+    int mergePasses = 0;   // passes over the data after run generation
+    double runSeconds = 0.0;
+    double mergeSeconds = 0.0;
+
+    double seconds() const { return runSeconds + mergeSeconds; }
+    // Input size over total time, in MB (2^20 bytes) per second
+    double megabytesPerSecond() const { return seconds() > 0.0 ? bytes / 1048576.0 / seconds() : 0.0; }
+};
+
+// Sequential reader of a binary file of T through one large buffer
+template <typename T>
+class RunReader {
+public:
+    RunReader(const std::string& path, size_t bufferElements)
+        : file(std::fopen(path.c_str(), "rb")), buffer(std::max<size_t>(bufferElements, 1)) {
+        if (file) std::setvbuf(file, nullptr, _IONBF, 0);  // the reader does its own buffering
+    }
+    ~RunReader() {
+        if (file) std::fclose(file);
+    }
+    RunReader(const RunReader&) = delete;
+    RunReader& operator=(const RunReader&) = delete;
+
+    bool isOpen() const { return file != nullptr; }
+    // A read error, or a file that ended inside an element
+    bool failed() const { return !file || std::ferror(file) || truncated; }
+
+    // The next element, or false at the end of the file
+    bool next(T& value) {
+        if (pos == count) {
+            // Read bytes, not elements, so that a partial element at the end is noticed
+            size_t bytes = std::fread(buffer.data(), 1, buffer.size() * sizeof(T), file);
+            count = bytes / sizeof(T);
+            truncated = truncated || bytes % sizeof(T) != 0;
+            pos = 0;
+            if (count == 0) return false;
+        }
+        value = buffer[pos++];
+        return true;
+    }
+
+private:
+    std::FILE* file;
+    std::vector<T> buffer;
+    size_t pos = 0;
+    size_t count = 0;
+    bool truncated = false;
+};
+
+// Sequential writer of a binary file of T. Full buffers are written in the background
+// while the caller fills the other one.
+template <typename T>
+class RunWriter {
+public:
+    RunWriter(const std::string& path, size_t bufferElements)
+        : file(std::fopen(path.c_str(), "wb")), buffer(std::max<size_t>(bufferElements, 1)), spare(buffer.size()) {
+        if (file) std::setvbuf(file, nullptr, _IONBF, 0);
+    }
+    ~RunWriter() { close(); }
+    RunWriter(const RunWriter&) = delete;
+    RunWriter& operator=(const RunWriter&) = delete;
+
+    bool isOpen() const { return file != nullptr; }
+
+    void push(const T& value) {
+        buffer[fill++] = value;
+        if (fill == buffer.size()) flush();
+    }
+
+    // Write a whole block directly, after whatever is buffered
+    void write(const T* data, size_t n) {
+        if (n == 0) return;
+        flush();
+        wait();
+        ok = ok && std::fwrite(data, sizeof(T), n, file) == n;
+    }
+
+    // Write everything and close the file; false if any write failed
+    bool close() {
+        if (!file) return false;
+        flush();
+        wait();
+        ok = std::fclose(file) == 0 && ok;
+        file = nullptr;
+        return ok;
+    }
+
+private:
+    // Hand the filled buffer to a background write and keep filling the spare one
+    void flush() {
+        if (fill == 0) return;
+        wait();
+        std::swap(buffer, spare);
+        pending = std::async(std::launch::async, [this, n = fill] {
+            return std::fwrite(spare.data(), sizeof(T), n, file) == n;
+        });
+        fill = 0;
+    }
+
+    void wait() {
+        if (pending.valid()) ok = pending.get() && ok;
+    }
+
+    std::FILE* file;
+    std::vector<T> buffer;
+    std::vector<T> spare;
+    size_t fill = 0;
+    std::future<bool> pending;
+    bool ok = true;
+};
+
+// A fresh path for a run file in `dir`
+inline std::string tempRunPath(const std::string& dir) {
+    static const unsigned token = std::random_device{}();  // keeps concurrent processes apart
+    static std::atomic<unsigned> counter{0};
+    std::filesystem::path base = dir.empty() ? std::filesystem::temp_directory_path() : std::filesystem::path(dir);
+    return (base / ("lab4-run-" + std::to_string(token) + "-" + std::to_string(counter++) + ".bin")).string();
+}
+
+// Merge the sorted files `inputs` into `output` through a loser tree
+template <typename T, typename Compare>
+bool mergeRunFiles(const std::vector<std::string>& inputs, const std::string& output, size_t bufferElements,
+                   Compare comp) {
+    std::vector<std::unique_ptr<RunReader<T>>> readers;
+    for (size_t i = 0; i < inputs.size(); ++i) {
+        readers.push_back(std::make_unique<RunReader<T>>(inputs[i], bufferElements));
+        if (!readers[i]->isOpen()) {
+            std::cerr << "Cannot open " << inputs[i] << " for reading" << std::endl;
+            return false;
+        }
+    }
+
+    RunWriter<T> writer(output, bufferElements);
+    if (!writer.isOpen()) {
+        std::cerr << "Cannot open " << output << " for writing" << std::endl;
+        return false;
+    }
+    mergeStreams<T>(readers.size(), [&readers](size_t i, T& value) { return readers[i]->next(value); },
+                    [&writer](const T& value) { writer.push(value); }, comp);
+    bool ok = writer.close();
+    for (const auto& reader : readers) ok = ok && !reader->failed();
+    return ok;
+}
+
+// Sort the binary file `inputPath` of T into `outputPath` (which may be the same file)
+// using about config.memoryBudget bytes. Run generation reads the next chunk in the
+// background while the current one is sorted and written, so each run is half the budget;
+// the runs are sorted in place, so the two chunk buffers are all the memory it takes.
+// When more runs exist than fit in one merge, groups of them are merged first.
+template <typename T, typename Compare = std::less<>>
+ExternalSortStats externalSort(const std::string& inputPath, const std::string& outputPath,
+                               const ExternalSortConfig& config = {}, Compare comp = {}) {
+    static_assert(std::is_trivially_copyable<T>::value, "External sort reads and writes raw keys");
+    ExternalSortStats stats;
+    auto start = std::chrono::steady_clock::now();
+
+    std::FILE* input = std::fopen(inputPath.c_str(), "rb");
+    if (!input) {
+        std::cerr << "Cannot open " << inputPath << " for reading" << std::endl;
+        return stats;
+    }
+    // fread counts whole keys, so a partial key at the end would be dropped without a word
+    std::error_code sizeError;
+    auto inputBytes = std::filesystem::file_size(inputPath, sizeError);
+    if (!sizeError && inputBytes % sizeof(T) != 0) {
+        std::cerr << inputPath << " holds " << inputBytes << " bytes, not a whole number of "
+                  << sizeof(T) << "-byte keys" << std::endl;
+        std::fclose(input);
+        return stats;
+    }
+    std::setvbuf(input, nullptr, _IONBF, 0);
+    size_t runElements = std::max<size_t>(config.memoryBudget / sizeof(T) / 2, 1);
+    std::vector<T> current(runElements);
+    std::vector<T> next(runElements);
+    std::vector<std::string> runs;
+
+    // Run generation. A short read is the end of the file only if the file has no error.
+    size_t count = std::fread(current.data(), sizeof(T), runElements, input);
+    bool ok = !std::ferror(input);
+    bool single = count < runElements;  // everything fit in one chunk: sort straight into the output
+    while (count > 0 && ok) {
+        std::future<size_t> ahead;
+        if (!single) {
+            ahead = std::async(std::launch::async, [&] { return std::fread(next.data(), sizeof(T), runElements, input); });
+        }
+        introSort(current.begin(), current.begin() + count, comp);
+        std::string path = single ? outputPath : tempRunPath(config.tempDir);
+        if (!single) runs.push_back(path);
+        {
+            RunWriter<T> writer(path, 0);
+            if (!writer.isOpen()) {
+                std::cerr << "Cannot open " << path << " for writing" << std::endl;
+                ok = false;
+            } else {
+                writer.write(current.data(), count);
+                ok = writer.close();
+            }
+        }
+        stats.elements += count;
+        count = single ? 0 : ahead.get();
+        ok = ok && !std::ferror(input);
+        std::swap(current, next);
+    }
+    ok = ok && !std::ferror(input);
+    std::fclose(input);
+    current = std::vector<T>();  // give the run buffers back before the merge
+    next = std::vector<T>();
+    bool generatedRuns = ok;  // every key is in a run file, or in the output when single
+    stats.runs = single ? (stats.elements > 0 ? 1 : 0) : runs.size();
+    stats.bytes = stats.elements * sizeof(T);
+    auto generated = std::chrono::steady_clock::now();
+    stats.runSeconds = std::chrono::duration<double>(generated - start).count();
+
+    if (single && stats.elements == 0 && ok) {
+        // Empty input: create the empty output
+        RunWriter<T> writer(outputPath, 1);
+        ok = writer.close();
+    }
+
+    // Merge passes: all buffers (fanIn readers plus the writer's two) fit in the budget.
+    // Buffers shrink so that all runs merge in one pass, but not below 64 KB, where the
+    // reads stop being large and sequential.
+    size_t ioBytes = std::min(config.ioBuffer, config.memoryBudget / (runs.size() + 2));
+    ioBytes = std::max({ioBytes, std::min({size_t(64) << 10, config.ioBuffer, config.memoryBudget / 4}), sizeof(T)});
+    size_t bufferElements = ioBytes / sizeof(T);
+    size_t buffers = config.memoryBudget / ioBytes;
+    size_t fanIn = std::max<size_t>(std::min(buffers > 4 ? buffers - 2 : 2, config.maxFanIn), 2);
+    std::error_code removeError;  // a run file that cannot be removed is not a failed sort
+    while (ok && runs.size() > fanIn) {
+        std::vector<std::string> merged;
+        for (size_t i = 0; i < runs.size(); i += fanIn) {
+            std::vector<std::string> group(runs.begin() + i, runs.begin() + std::min(i + fanIn, runs.size()));
+            // After a failure the remaining groups are left unmerged, their runs untouched
+            if (group.size() == 1 || !ok) {
+                merged.insert(merged.end(), group.begin(), group.end());
+                continue;
+            }
+            std::string path = tempRunPath(config.tempDir);
+            ok = mergeRunFiles<T>(group, path, bufferElements, comp);
+            if (ok) {
+                merged.push_back(path);
+                for (const auto& run : group) std::filesystem::remove(run, removeError);
+            } else {
+                std::filesystem::remove(path, removeError);
+                merged.insert(merged.end(), group.begin(), group.end());
+            }
+        }
+        runs = merged;
+        ++stats.mergePasses;
+    }
+    if (ok && !runs.empty()) {
+        ok = mergeRunFiles<T>(runs, outputPath, bufferElements, comp);
+        ++stats.mergePasses;
+    }
+    if (ok || !generatedRuns) {
+        for (const auto& run : runs) std::filesystem::remove(run, removeError);
+    } else if (!runs.empty()) {
+        // A merge failed: the output may be incomplete (and may have replaced the input),
+        // so the sorted runs are the only complete copy of the data
+        std::cerr << "External sort failed; keeping its " << runs.size() << " run files:" << std::endl;
+        for (const auto& run : runs) std::cerr << "  " << run << std::endl;
+    }
+    stats.mergeSeconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - generated).count();
+    stats.ok = ok;
+    return stats;
+}
+
+// Whether the binary file of T at `path` is sorted by `comp`, read in one pass
+template <typename T, typename Compare = std::less<>>
+bool isSortedFile(const std::string& path, Compare comp = {}, size_t bufferElements = size_t(1) << 18) {
+    RunReader<T> reader(path, bufferElements);
+    T previous, value;
+    if (!reader.next(previous)) return !reader.failed();
+    while (reader.next(value)) {
+        if (comp(value, previous)) return false;
+        previous = value;
+    }
+    return !reader.failed();
+}
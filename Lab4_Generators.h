@@ -0,0 +1,173 @@
+#pragma once
+
+#include <algorithm>
+#include <cmath>
+#include <random>
+#include <string>
+#include <vector>
+
+// Input patterns used by the benchmarks
+enum class Distribution {
+    Uniform,         // uniform random keys in [min, max]
+    Sorted,          // ascending
+    Reverse,         // descending
+    NearlySorted,    // ascending with size / 100 random swaps
+    OrganPipe,       // ascending first half, descending second half
+    Sawtooth,        // about sqrt(size) ascending runs
+    FewUnique,       // only 8 distinct keys
+    AllEqual,        // every key is the same
+    Zipf,            // skewed keys, the r-th smallest key has weight 1 / r
+    MedianOf3Killer  // Musser's adversary for median-of-three quicksort
+};
+
+// Seed used when the caller does not pass one, so every run sees the same data
+const unsigned defaultSeed = 12345;
+
+// Every distribution, in the order the benchmarks report them
+inline const std::vector<Distribution>& allDistributions() {
+    static const std::vector<Distribution> all = {
+        Distribution::Uniform, Distribution::Sorted, Distribution::Reverse,
+        Distribution::NearlySorted, Distribution::OrganPipe, Distribution::Sawtooth,
+        Distribution::FewUnique, Distribution::AllEqual, Distribution::Zipf,
+        Distribution::MedianOf3Killer
+    };
+    return all;
+}
+
+// Human-readable name of a distribution
+inline std::string distributionName(Distribution dist) {
+    switch (dist) {
+        case Distribution::Uniform: return "uniform";
+        case Distribution::Sorted: return "sorted";
+        case Distribution::Reverse: return "reverse";
+        case Distribution::NearlySorted: return "nearly-sorted";
+        case Distribution::OrganPipe: return "organ-pipe";
+        case Distribution::Sawtooth: return "sawtooth";
+        case Distribution::FewUnique: return "few-unique";
+        case Distribution::AllEqual: return "all-equal";
+        case Distribution::Zipf: return "zipf";
+        case Distribution::MedianOf3Killer: return "median-of-3-killer";
+    }
+    return "unknown";
+}
+
+// Uniform random keys in [min, max]
+inline std::vector<int> uniformList(int size, int min, int max, std::mt19937& gen) {
+    std::vector<int> list(size);
+    std::uniform_int_distribution<> dist(min, max);
+    for (int& num : list) {
+        num = dist(gen);
+    }
+    return list;
+}
+
+// Swap `swaps` random pairs of elements
+inline void randomSwaps(std::vector<int>& list, int swaps, std::mt19937& gen) {
+    if (list.size() < 2) return;
+    std::uniform_int_distribution<size_t> index(0, list.size() - 1);
+    for (int i = 0; i < swaps; ++i) {
+        std::swap(list[index(gen)], list[index(gen)]);
+    }
+}
+
+// Zipf-distributed keys: rank r is drawn with weight 1 / r
+inline std::vector<int> zipfList(int size, int min, int max, std::mt19937& gen) {
+    // Cap the number of ranks so the table stays small for huge key ranges
+    long long range = static_cast<long long>(max) - min + 1;
+    int ranks = static_cast<int>(std::min<long long>(range, 1 << 20));
+    long long step = range / ranks;
+
+    std::vector<double> cdf(ranks);
+    double total = 0.0;
+    for (int r = 0; r < ranks; ++r) {
+        total += 1.0 / (r + 1);
+        cdf[r] = total;
+    }
+
+    std::vector<int> list(size);
+    std::uniform_real_distribution<> dist(0.0, total);
+    for (int& num : list) {
+        int rank = std::lower_bound(cdf.begin(), cdf.end(), dist(gen)) - cdf.begin();
+        rank = std::min(rank, ranks - 1);
+        num = static_cast<int>(min + rank * step);
+    }
+    return list;
+}
+
+// Musser's median-of-three killer: drives first/middle/last pivot selection quadratic.
+// The keys are a permutation of 1..size, so `min` and `max` are ignored.
+inline std::vector<int> medianOf3KillerList(int size) {
+    std::vector<int> list(size);
+    // The construction needs an even half, so it covers the largest multiple of 4;
+    // the remaining keys are appended in order.
+    int k = size / 4 * 2;
+    for (int i = 1; i <= k; ++i) {
+        if (i % 2 == 1) {
+            list[i - 1] = i;
+            list[i] = k + i;
+        }
+        list[k + i - 1] = 2 * i;
+    }
+    for (int i = 2 * k; i < size; ++i) list[i] = i + 1;
+    return list;
+}
+
+// Generate `size` keys in [min, max] following `dist`; the same seed always gives the same list
+inline std::vector<int> generateList(Distribution dist, int size, int min = 1, int max = 1000,
+                                     unsigned seed = defaultSeed) {
+    std::mt19937 gen(seed);
+    std::vector<int> list;
+    switch (dist) {
+        case Distribution::Uniform:
+            list = uniformList(size, min, max, gen);
+            break;
+        case Distribution::Sorted:
+            list = uniformList(size, min, max, gen);
+            std::sort(list.begin(), list.end());
+            break;
+        case Distribution::Reverse:
+            list = uniformList(size, min, max, gen);
+            std::sort(list.begin(), list.end(), [](int a, int b) { return a > b; });
+            break;
+        case Distribution::NearlySorted:
+            list = uniformList(size, min, max, gen);
+            std::sort(list.begin(), list.end());
+            randomSwaps(list, std::max(1, size / 100), gen);
+            break;
+        case Distribution::OrganPipe: {
+            // Even positions of the sorted keys go up, odd positions come back down
+            auto sorted = uniformList(size, min, max, gen);
+            std::sort(sorted.begin(), sorted.end());
+            for (int i = 0; i < size; i += 2) list.push_back(sorted[i]);
+            for (int i = size - 1 - (size % 2 == 0 ? 0 : 1); i > 0; i -= 2) list.push_back(sorted[i]);
+            break;
+        }
+        case Distribution::Sawtooth: {
+            list = uniformList(size, min, max, gen);
+            int run = std::max(2, static_cast<int>(std::sqrt(static_cast<double>(size))));
+            for (int start = 0; start < size; start += run) {
+                std::sort(list.begin() + start, list.begin() + std::min(size, start + run));
+            }
+            break;
+        }
+        case Distribution::FewUnique: {
+            auto keys = uniformList(8, min, max, gen);
+            std::uniform_int_distribution<> pick(0, keys.size() - 1);
+            list.resize(size);
+            for (int& num : list) {
+                num = keys[pick(gen)];
+            }
+            break;
+        }
+        case Distribution::AllEqual:
+            list.assign(size, min + (max - min) / 2);
+            break;
+        case Distribution::Zipf:
+            list = zipfList(size, min, max, gen);
+            break;
+        case Distribution::MedianOf3Killer:
+            list = medianOf3KillerList(size);
+            break;
+    }
+    return list;
+}
@@ -0,0 +1,362 @@
+#pragma once
+
+#include <algorithm>
+#include <cstddef>
+#include <functional>
+#include <iterator>
+#include <ranges>
+#include <utility>
+#include <vector>
+
+// The heaps here are max-heaps by `comp` (largest on top) stored in [first, first + n), with the
+// children of node i at Arity * i + 1 .. Arity * i + Arity. Arity 2 is the classic binary heap;
+// a 4- or 8-ary heap is half or a third as deep and keeps all children of a node in one or two
+// cache lines, trading more comparisons per level for fewer levels and fewer cache misses.
+
+// Called with the index of every element a sift moves, so an addressable heap can track
+// where its elements are; the default tracks nothing and compiles away
+struct NoHeapTracking {
+    void operator()(long) const {}
+};
+
+// Compares in the opposite order: a max-heap by ReverseCompare<Compare> keeps the smallest on top
+template <typename Compare = std::less<>>
+struct ReverseCompare {
+    Compare comp{};
+
+    template <typename A, typename B>
+    bool operator()(A&& a, B&& b) const {
+        return comp(std::forward<B>(b), std::forward<A>(a));
+    }
+};
+
+// Largest child of a node whose first child is `child` (which must be < n)
+template <int Arity, typename It, typename Compare>
+long largestChild(It first, long n, long child, Compare& comp) {
+    if constexpr (Arity == 2) {
+        // Which child wins is a coin flip on random data, so it is added rather than branched on
+        return child + (child + 1 < n && comp(first[child], first[child + 1]));
+    } else {
+        long best = child;
+        long last = std::min(child + Arity, n);
+        for (long c = child + 1; c < last; ++c) {
+            best = comp(first[best], first[c]) ? c : best;
+        }
+        return best;
+    }
+}
+
+// Move first[hole] up towards `top` until its parent is not smaller.
+// The element is held out of the array, so every level costs one move instead of a swap.
+template <int Arity = 2, typename It, typename Compare, typename Track = NoHeapTracking>
+void siftUp(It first, long top, long hole, Compare comp, Track track = {}) {
+    auto value = std::move(first[hole]);
+    while (hole > top) {
+        long parent = (hole - 1) / Arity;
+        if (!comp(first[parent], value)) break;
+        first[hole] = std::move(first[parent]);
+        track(hole);
+        hole = parent;
+    }
+    first[hole] = std::move(value);
+    track(hole);
+}
+
+// Move first[hole] down until no child is larger, iteratively and with one move per level
+template <int Arity = 2, typename It, typename Compare, typename Track = NoHeapTracking>
+void siftDown(It first, long n, long hole, Compare comp, Track track = {}) {
+    auto value = std::move(first[hole]);
+    for (long child = Arity * hole + 1; child < n; child = Arity * hole + 1) {
+        long best = largestChild<Arity>(first, n, child, comp);
+        if (!comp(value, first[best])) break;
+        first[hole] = std::move(first[best]);
+        track(hole);
+        hole = best;
+    }
+    first[hole] = std::move(value);
+    track(hole);
+}
+
+// Bottom-up sift-down (Floyd, Wegener) for an element expected to sink to the bottom, such as
+// the last leaf moved to the root by a pop: follow the larger children all the way down without
+// comparing against the element, then climb back up to its place. On a binary heap this needs
+// about half the comparisons of siftDown.
+template <int Arity = 2, typename It, typename Compare, typename Track = NoHeapTracking>
+void siftDownBottomUp(It first, long n, long hole, Compare comp, Track track = {}) {
+    long top = hole;
+    auto value = std::move(first[hole]);
+    for (long child = Arity * hole + 1; child < n; child = Arity * hole + 1) {
+        long best = largestChild<Arity>(first, n, child, comp);
+        first[hole] = std::move(first[best]);
+        track(hole);
+        hole = best;
+    }
+    first[hole] = std::move(value);
+    siftUp<Arity>(first, top, hole, comp, track);
+}
+
+// Function to heapify a subtree with the root at index `i`
+// `n` is the size of the heap [first, first + n), ordered by `comp` (largest on top)
+template <typename It, typename Compare = std::less<>>
+void heapify(It first, long n, long i, Compare comp = {}) {
+    siftDown<2>(first, n, i, comp);
+}
+
+// Function to heapify a subtree with the root at index `i`
+// `n` is the size of the heap, which starts at arr[offset]
+template <typename T>
+void heapify(std::vector<T>& arr, int n, int i, int offset = 0) {
+    heapify(arr.begin() + offset, n, i);
+}
+
+// Function to build a Max-Heap from [first, last) with Floyd's bottom-up construction:
+// sift down every internal node from the last one to the root, O(n) in total
+template <int Arity = 2, typename It, typename Compare = std::less<>>
+void buildMaxHeap(It first, It last, Compare comp = {}) {
+    long n = last - first;
+    if (n < 2) return;
+    // Start from the last non-leaf node and heapify each node
+    for (long i = (n - 2) / Arity; i >= 0; --i) {
+        siftDown<Arity>(first, n, i, comp);
+    }
+}
+
+// Function to build a Max-Heap from arr[low..high]
+template <typename T>
+void buildMaxHeap(std::vector<T>& arr, int low, int high) {
+    buildMaxHeap(arr.begin() + low, arr.begin() + high + 1);
+}
+
+// Function to build a Max-Heap from the array
+template <typename T>
+void buildMaxHeap(std::vector<T>& arr) {
+    buildMaxHeap(arr.begin(), arr.end());
+}
+
+// Heap Sort of [first, last) by `comp`: O(n log n) in the worst case, used as the introsort fallback.
+// heapSort<4> and heapSort<8> sort through a 4- or 8-ary heap.
+template <int Arity = 2, typename It, typename Compare = std::less<>>
+    requires std::random_access_iterator<It>
+void heapSort(It first, It last, Compare comp = {}) {
+    buildMaxHeap<Arity>(first, last, comp);
+    // Move the current maximum behind the heap; the leaf it swaps with sinks from the root
+    for (long n = last - first; n > 1; --n) {
+        std::swap(first[0], first[n - 1]);
+        siftDownBottomUp<Arity>(first, n - 1, 0, comp);
+    }
+}
+
+// Heap Sort of arr[low..high]
+template <typename T>
+void heapSort(std::vector<T>& arr, int low, int high) {
+    if (low >= high) return;
+    heapSort(arr.begin() + low, arr.begin() + high + 1);
+}
+
+// Addressable d-ary priority queue. top() is the first element in `comp` order (the smallest
+// with std::less, as at the front of a sorted range), so decreaseKey() is the operation
+// Dijkstra's and Prim's algorithms need. push() returns a handle that stays valid until its
+// element is popped or erased; the handles of removed elements are reused.
+// The heap is 4-ary by default, so pushes and decrease-keys climb a tree half as deep.
+template <typename T, typename Compare = std::less<>, int Arity = 4>
+class PriorityQueue {
+public:
+    using Handle = size_t;
+
+    explicit PriorityQueue(Compare comp = {}) : comp(comp) {}
+
+    bool empty() const { return heap.empty(); }
+    size_t size() const { return heap.size(); }
+
+    void reserve(size_t n) {
+        heap.reserve(n);
+        positions.reserve(n);
+    }
+
+    const T& top() const { return heap.front().value; }
+    Handle topHandle() const { return heap.front().handle; }
+
+    // Whether `handle` names an element still in the queue
+    bool contains(Handle handle) const { return handle < positions.size() && positions[handle] >= 0; }
+    const T& value(Handle handle) const { return heap[positions[handle]].value; }
+
+    Handle push(T value) {
+        Handle handle;
+        if (freeHandles.empty()) {
+            handle = positions.size();
+            positions.push_back(0);
+        } else {
+            handle = freeHandles.back();
+            freeHandles.pop_back();
+        }
+        heap.push_back({std::move(value), handle});
+        siftUp<Arity>(heap.begin(), 0, static_cast<long>(heap.size()) - 1, order(), tracker());
+        return handle;
+    }
+
+    // Remove and return the top element
+    T pop() { return removeAt(0); }
+
+    // Remove the element of `handle` wherever it is
+    T erase(Handle handle) { return removeAt(positions[handle]); }
+
+    // The element of `handle` becomes `value`, which must not come later in `comp` order
+    void decreaseKey(Handle handle, T value) {
+        long position = positions[handle];
+        heap[position].value = std::move(value);
+        siftUp<Arity>(heap.begin(), 0, position, order(), tracker());
+    }
+
+    // The element of `handle` becomes `value`, which must not come earlier in `comp` order
+    void increaseKey(Handle handle, T value) {
+        long position = positions[handle];
+        heap[position].value = std::move(value);
+        siftDown<Arity>(heap.begin(), static_cast<long>(heap.size()), position, order(), tracker());
+    }
+
+    // The element of `handle` becomes `value`, in whichever direction
+    void update(Handle handle, T value) {
+        long position = positions[handle];
+        heap[position].value = std::move(value);
+        restore(position);
+    }
+
+    void clear() {
+        heap.clear();
+        positions.clear();
+        freeHandles.clear();
+    }
+
+private:
+    struct Entry {
+        T value;
+        Handle handle;
+    };
+
+    // The heap functions keep the largest on top, so the queue orders its entries in reverse
+    auto order() const {
+        return [this](const Entry& a, const Entry& b) { return comp(b.value, a.value); };
+    }
+
+    auto tracker() {
+        return [this](long position) { positions[heap[position].handle] = position; };
+    }
+
+    // Sift the entry at `position` whichever way restores the heap
+    void restore(long position) {
+        if (position > 0 && order()(heap[(position - 1) / Arity], heap[position])) {
+            siftUp<Arity>(heap.begin(), 0, position, order(), tracker());
+        } else {
+            siftDown<Arity>(heap.begin(), static_cast<long>(heap.size()), position, order(), tracker());
+        }
+    }
+
+    T removeAt(long position) {
+        Handle handle = heap[position].handle;
+        positions[handle] = -1;
+        freeHandles.push_back(handle);
+        T value = std::move(heap[position].value);
+        long last = static_cast<long>(heap.size()) - 1;
+        if (position != last) {
+            heap[position] = std::move(heap[last]);
+            heap.pop_back();
+            if (position == 0) {
+                // The old last leaf almost always sinks back to the bottom
+                siftDownBottomUp<Arity>(heap.begin(), last, 0, order(), tracker());
+            } else {
+                restore(position);
+            }
+        } else {
+            heap.pop_back();
+        }
+        return value;
+    }
+
+    std::vector<Entry> heap;
+    std::vector<long> positions;  // heap index of every handle, -1 once removed
+    std::vector<Handle> freeHandles;
+    Compare comp;
+};
+
+// Keeps the k largest values by `comp` seen in a stream, in O(k) memory: a heap of the kept
+// values with the smallest on top as the admission threshold. A value that does not beat the
+// threshold costs one comparison, which is almost every value of a long random stream, so n
+// values cost O(n log k) at worst and close to n comparisons in practice.
+// Ties keep the value seen first. The heap stays binary by default: it is small and hot in
+// cache, and a wider node only adds comparisons to every replacement.
+template <typename T, typename Compare = std::less<>, int Arity = 2>
+class TopK {
+public:
+    explicit TopK(size_t k, Compare comp = {}) : k(k), comp(comp) { heap.reserve(k); }
+
+    size_t capacity() const { return k; }
+    size_t size() const { return heap.size(); }
+    bool full() const { return heap.size() == k; }
+
+    // Smallest kept value, the one a new value has to beat once the selector is full
+    const T& threshold() const { return heap.front(); }
+
+    void push(const T& value) {
+        if (heap.size() < k) {
+            heap.push_back(value);
+            siftUp<Arity>(heap.begin(), 0, static_cast<long>(heap.size()) - 1, order());
+        } else if (k > 0 && comp(heap.front(), value)) {
+            replaceThreshold(value);
+        }
+    }
+
+    // One batch of the stream
+    template <std::ranges::input_range R>
+    void pushBatch(R&& batch) {
+        auto it = std::ranges::begin(batch);
+        auto end = std::ranges::end(batch);
+        for (; it != end && heap.size() < k; ++it) push(*it);
+        if (k == 0) return;
+        // Once full, a value only meets the threshold unless it gets in
+        for (; it != end; ++it) {
+            if (comp(heap.front(), *it)) replaceThreshold(*it);
+        }
+    }
+
+    // Fold in the values kept by another selector, e.g. one per thread or per shard
+    void merge(const TopK& other) { pushBatch(other.heap); }
+
+    // Kept values, best first
+    std::vector<T> sorted() const {
+        std::vector<T> values = heap;
+        std::sort(values.begin(), values.end(), order());
+        return values;
+    }
+
+    void clear() { heap.clear(); }
+
+private:
+    ReverseCompare<Compare> order() const { return {comp}; }
+
+    void replaceThreshold(const T& value) {
+        heap.front() = value;
+        siftDownBottomUp<Arity>(heap.begin(), static_cast<long>(k), 0, order());
+    }
+
+    size_t k;
+    std::vector<T> heap;
+    Compare comp;
+};
+
+// Keeps the k smallest values by `comp`
+template <typename T, typename Compare = std::less<>, int Arity = 2>
+using BottomK = TopK<T, ReverseCompare<Compare>, Arity>;
+
+// The k largest values of [first, last) by `comp`, best first, in one pass and O(k) memory
+template <std::input_iterator It, typename Compare = std::less<>>
+std::vector<std::iter_value_t<It>> topK(It first, It last, size_t k, Compare comp = {}) {
+    TopK<std::iter_value_t<It>, Compare> selector(k, comp);
+    for (; first != last; ++first) selector.push(*first);
+    return selector.sorted();
+}
+
+// The k smallest values of [first, last) by `comp`, smallest first
+template <std::input_iterator It, typename Compare = std::less<>>
+std::vector<std::iter_value_t<It>> bottomK(It first, It last, size_t k, Compare comp = {}) {
+    return topK(first, last, k, ReverseCompare<Compare>{comp});
+}
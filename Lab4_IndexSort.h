@@ -0,0 +1,143 @@
+#pragma once
+
+#include <algorithm>
+#include <concepts>
+#include <cstdint>
+#include <functional>
+#include <string>
+#include <type_traits>
+#include <utility>
+#include <vector>
+#include "Lab4_RadixSort.h"
+
+// One entry of an index sort: an order-preserving 64-bit prefix of the key and the
+// position of the element it came from. Sorting these 16-byte entries instead of the
+// elements keeps the sort in cache and never moves the payloads.
+struct PrefixIndex {
+    uint64_t prefix;
+    size_t index;
+};
+
+// Lets lsdRadixSort order entries by prefix
+inline uint64_t radixKey(const PrefixIndex& entry) { return entry.prefix; }
+
+// Order-preserving prefix of a key: a < b whenever keyPrefix(a) < keyPrefix(b).
+// Integers and float/double map to their full radix key; other types may provide
+// their own keyPrefix overload, which is found by ADL.
+template <typename T>
+    requires std::is_integral<T>::value || std::is_same<T, float>::value || std::is_same<T, double>::value
+uint64_t keyPrefix(const T& key) {
+    if constexpr (std::is_integral<T>::value && std::is_signed<T>::value) {
+        return radixKey(static_cast<int64_t>(key));
+    } else if constexpr (std::is_integral<T>::value) {
+        return static_cast<uint64_t>(key);
+    } else {
+        return radixKey(key);
+    }
+}
+
+// The first 8 bytes of a string, big-endian and zero-padded
+inline uint64_t keyPrefix(const std::string& key) {
+    uint64_t prefix = 0;
+    for (size_t i = 0; i < 8; ++i) {
+        prefix = (prefix << 8) | (i < key.size() ? static_cast<unsigned char>(key[i]) : 0u);
+    }
+    return prefix;
+}
+
+// Whether T has a keyPrefix; keys without one, such as std::pair, all get prefix 0 and
+// are ordered by comparisons alone
+template <typename T>
+concept HasKeyPrefix = requires(const T& key) {
+    { keyPrefix(key) } -> std::convertible_to<uint64_t>;
+};
+
+// Prefix of a key for the index sorts: keyPrefix(key), or 0 for keys without one
+template <typename T>
+uint64_t keyPrefixOrZero(const T& key) {
+    if constexpr (HasKeyPrefix<T>) return keyPrefix(key);
+    else return 0;
+}
+
+// Whether equal prefixes imply equal keys, so ties need no further comparison
+template <typename T>
+constexpr bool prefixIsExact = std::is_integral<T>::value || std::is_same<T, float>::value ||
+                               std::is_same<T, double>::value;
+
+// Stable sorting permutation of [first, last): first[perm[0]], first[perm[1]], ... is sorted
+// by `comp` and equal elements keep their order. The range is only read. The (prefix, index)
+// entries are radix sorted by prefix(element), which must order elements the way `comp`
+// does wherever two prefixes differ; runs of equal prefixes are then ordered with `comp`
+// itself unless `exact` says equal prefixes mean equal elements.
+template <typename It, typename PrefixFn, typename Compare>
+std::vector<size_t> sortPermutation(It first, It last, PrefixFn prefix, Compare comp, bool exact) {
+    size_t n = last - first;
+    std::vector<PrefixIndex> entries(n);
+    for (size_t i = 0; i < n; ++i) {
+        entries[i] = {prefix(first[i]), i};
+    }
+    std::vector<PrefixIndex> buffer;
+    lsdRadixSort(entries.begin(), entries.end(), buffer);
+
+    if (!exact) {
+        auto byKey = [first, &comp](const PrefixIndex& a, const PrefixIndex& b) {
+            return comp(first[a.index], first[b.index]);
+        };
+        for (size_t start = 0; start < n;) {
+            size_t end = start + 1;
+            while (end < n && entries[end].prefix == entries[start].prefix) ++end;
+            if (end - start > 1) {
+                std::stable_sort(entries.begin() + start, entries.begin() + end, byKey);
+            }
+            start = end;
+        }
+    }
+
+    std::vector<size_t> perm(n);
+    for (size_t i = 0; i < n; ++i) perm[i] = entries[i].index;
+    return perm;
+}
+
+// Stable sorting permutation of arr by keyPrefix and operator<
+template <typename T>
+std::vector<size_t> sortPermutation(const std::vector<T>& arr) {
+    return sortPermutation(arr.begin(), arr.end(), [](const T& x) { return keyPrefixOrZero(x); }, std::less<>(),
+                           prefixIsExact<T>);
+}
+
+// Reorder [first, first + perm.size()) in place so that the new first[i] is the old
+// first[perm[i]]. Each permutation cycle is followed once with a single temporary, so
+// every element is moved exactly once (plus one move per cycle). perm is left as the identity.
+template <typename It>
+void applyPermutation(It first, std::vector<size_t>& perm) {
+    size_t n = perm.size();
+    for (size_t start = 0; start < n; ++start) {
+        if (perm[start] == start) continue;
+        auto temp = std::move(first[start]);
+        size_t current = start;
+        while (true) {
+            size_t next = perm[current];
+            perm[current] = current;
+            if (next == start) {
+                first[current] = std::move(temp);
+                break;
+            }
+            first[current] = std::move(first[next]);
+            current = next;
+        }
+    }
+}
+
+// Reorder arr in place so that the new arr[i] is the old arr[perm[i]]
+template <typename T>
+void applyPermutation(std::vector<T>& arr, std::vector<size_t>& perm) {
+    applyPermutation(arr.begin(), perm);
+}
+
+// Index Sort: sort the compact (prefix, index) entries, then move every element to its
+// final place once. Stable. Pays off when elements are expensive to copy or compare.
+template <typename T>
+void indexSort(std::vector<T>& arr) {
+    std::vector<size_t> perm = sortPermutation(arr);
+    applyPermutation(arr, perm);
+}
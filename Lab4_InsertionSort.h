@@ -0,0 +1,160 @@
+#pragma once
+
+#include <algorithm>
+#include <cstring>
+#include <functional>
+#include <iterator>
+#include <memory>
+#include <string>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+// Insertion Sort of [first, last) by `comp`. Elements are moved, never copied,
+// so move-only types such as std::unique_ptr sort as well.
+template <typename It, typename Compare = std::less<>>
+    requires std::random_access_iterator<It>
+void insertionSort(It first, It last, Compare comp = {}) {
+    if (first == last) return;
+    for (It i = first + 1; i != last; ++i) {
+        auto key = std::move(*i);
+        It j = i;
+        while (j != first && comp(key, *(j - 1))) {
+            *j = std::move(*(j - 1));
+            --j;
+        }
+        *j = std::move(key);
+    }
+}
+
+// Insertion Sort for small subarrays arr[left..right]
+template <typename T>
+void insertionSort(std::vector<T>& arr, int left, int right) {
+    if (left >= right) return;
+    insertionSort(arr.begin() + left, arr.begin() + right + 1);
+}
+
+// How binaryInsertionSort finds the slot of each new key. Every mode puts a key after the
+// keys equal to it, so the sort is stable whichever search runs.
+enum class InsertionSearch {
+    Auto,        // Gallop while keys land near the end of the sorted prefix, Branchless otherwise
+    Branchless,  // branch-free binary search over the whole sorted prefix
+    Gallop       // exponential search back from the end of the sorted prefix
+};
+
+// Human-readable name of an insertion search
+inline std::string insertionSearchName(InsertionSearch search) {
+    switch (search) {
+        case InsertionSearch::Auto: return "auto";
+        case InsertionSearch::Branchless: return "branchless";
+        case InsertionSearch::Gallop: return "gallop";
+    }
+    return "unknown";
+}
+
+// Sorted prefixes at least this long prefetch the next probes of a branchless search
+const long searchPrefetchLimit = 256;
+
+// Branch-free binary search over the n elements from first: the range halves on every step
+// whether or not the probe succeeds, and the comparison only selects the next base
+// (a conditional move), so there is no branch to mispredict. On long contiguous ranges
+// both possible next probes are prefetched while the current one is compared.
+// With Upper it returns the first element greater than key, otherwise the first not less.
+template <bool Upper, typename It, typename T, typename Compare>
+It branchlessBound(It first, long n, const T& key, Compare& comp) {
+    if (n == 0) return first;
+    while (n > 1) {
+        long half = n / 2;
+        if constexpr (std::contiguous_iterator<It>) {
+            if (n >= searchPrefetchLimit) {
+                __builtin_prefetch(std::to_address(first + half / 2));
+                __builtin_prefetch(std::to_address(first + half + half / 2));
+            }
+        }
+        bool right = Upper ? !comp(key, first[half]) : static_cast<bool>(comp(first[half], key));
+        first += right ? half : 0;
+        n -= half;
+    }
+    return first + (Upper ? !comp(key, *first) : static_cast<bool>(comp(*first, key)));
+}
+
+// First element of [first, last) greater than key
+template <typename It, typename T, typename Compare = std::less<>>
+    requires std::random_access_iterator<It>
+It branchlessUpperBound(It first, It last, const T& key, Compare comp = {}) {
+    return branchlessBound<true>(first, last - first, key, comp);
+}
+
+// First element of [first, last) not less than key
+template <typename It, typename T, typename Compare = std::less<>>
+    requires std::random_access_iterator<It>
+It branchlessLowerBound(It first, It last, const T& key, Compare comp = {}) {
+    return branchlessBound<false>(first, last - first, key, comp);
+}
+
+// First element of [first, last) greater than key, found by probing last[-1], last[-2],
+// last[-4], ... before a binary search of the last gap: O(log d) when the answer is d
+// elements before last, one comparison when key belongs at the end
+template <typename It, typename T, typename Compare>
+It gallopUpperFromEnd(It first, It last, const T& key, Compare& comp) {
+    long n = last - first;
+    long bound = 1;
+    while (bound <= n && comp(key, last[-bound])) bound *= 2;
+    It low = last - std::min(bound, n);
+    return branchlessBound<true>(low, (last - bound / 2) - low, key, comp);
+}
+
+// Move [from, to) one slot right and put `key` in the hole at from. Trivially
+// copyable elements in contiguous storage are shifted with one memmove.
+template <typename It, typename T>
+void insertShift(It from, It to, T&& key) {
+    using Value = std::iter_value_t<It>;
+    if constexpr (std::contiguous_iterator<It> && std::is_trivially_copyable_v<Value>) {
+        Value* base = std::to_address(from);
+        std::memmove(static_cast<void*>(base + 1), static_cast<const void*>(base), (to - from) * sizeof(Value));
+    } else {
+        std::move_backward(from, to, to + 1);
+    }
+    *from = std::forward<T>(key);
+}
+
+// Binary Insertion Sort of [first, last) whose prefix [first, sorted) is already in order:
+// `search` finds the slot of every later key and the keys after that slot are shifted in
+// bulk. Stable, and elements are only moved. About n log n comparisons against Insertion
+// Sort's n^2 / 4, which pays off when comparing keys costs more than moving them, and with
+// galloping, sorted and nearly sorted input costs little more than one comparison per key.
+template <typename It, typename Compare = std::less<>>
+    requires std::random_access_iterator<It>
+void binaryInsertionSortFrom(It first, It sorted, It last, Compare comp = {},
+                             InsertionSearch search = InsertionSearch::Auto) {
+    if (sorted == first && first != last) ++sorted;
+    bool gallop = search != InsertionSearch::Branchless;
+    for (It i = sorted; i != last; ++i) {
+        // Keys already in place cost one comparison whichever search runs
+        if (!comp(*i, i[-1])) {
+            if (search == InsertionSearch::Auto) gallop = true;
+            continue;
+        }
+        It pos = gallop ? gallopUpperFromEnd(first, i - 1, *i, comp)
+                        : branchlessBound<true>(first, i - 1 - first, *i, comp);
+        // Galloping probes close to the end of the prefix with branches that are easy to
+        // predict, so Auto only gives it up for a key that went into the front quarter
+        if (search == InsertionSearch::Auto) gallop = 4 * (i - pos) <= i - first;
+        auto key = std::move(*i);
+        insertShift(pos, i, std::move(key));
+    }
+}
+
+// Binary Insertion Sort of [first, last); see above
+template <typename It, typename Compare = std::less<>>
+    requires std::random_access_iterator<It>
+void binaryInsertionSort(It first, It last, Compare comp = {}, InsertionSearch search = InsertionSearch::Auto) {
+    binaryInsertionSortFrom(first, first, last, comp, search);
+}
+
+// Binary Insertion Sort of arr[left..right]
+template <typename T>
+void binaryInsertionSort(std::vector<T>& arr, int left, int right) {
+    if (left >= right) return;
+    binaryInsertionSort(arr.begin() + left, arr.begin() + right + 1);
+}
@@ -0,0 +1,123 @@
+#pragma once
+
+#include <functional>
+#include <iterator>
+#include <tuple>
+#include <utility>
+#include <vector>
+#include "Lab4_Heap.h"
+#include "Lab4_InsertionSort.h"
+#include "Lab4_Partition.h"
+#include "Lab4_SortingNetwork.h"
+
+// The median of *a, *b and *c
+template <typename It, typename Compare = std::less<>>
+It medianOfThree(It a, It b, It c, Compare comp = {}) {
+    if (comp(*a, *b)) {
+        if (comp(*b, *c)) return b;
+        return comp(*a, *c) ? c : a;
+    }
+    if (comp(*a, *c)) return a;
+    return comp(*b, *c) ? c : b;
+}
+
+// Index of the median of arr[a], arr[b] and arr[c]
+template <typename T>
+int medianOfThree(const std::vector<T>& arr, int a, int b, int c) {
+    return medianOfThree(arr.begin() + a, arr.begin() + b, arr.begin() + c) - arr.begin();
+}
+
+// Pick a pivot for [first, last): median of three for small ranges,
+// Tukey's ninther (median of three medians) for large ones
+template <typename It, typename Compare = std::less<>>
+It choosePivot(It first, It last, Compare comp = {}) {
+    auto n = last - first;
+    It mid = first + n / 2, back = last - 1;
+    if (n < 128) {
+        return medianOfThree(first, mid, back, comp);
+    }
+    auto step = n / 8;
+    It low = medianOfThree(first, first + step, first + 2 * step, comp);
+    It middle = medianOfThree(mid - step, mid, mid + step, comp);
+    It high = medianOfThree(back - 2 * step, back - step, back, comp);
+    return medianOfThree(low, middle, high, comp);
+}
+
+// Index of the pivot choosePivot picks for arr[low..high]
+template <typename T>
+int choosePivot(const std::vector<T>& arr, int low, int high) {
+    return choosePivot(arr.begin() + low, arr.begin() + high + 1) - arr.begin();
+}
+
+// Two-way partition around the chosen pivot, which is first moved to last[-1]
+template <typename It, typename Compare = std::less<>>
+It introPartition(It first, It last, PartitionScheme scheme = PartitionScheme::Lomuto, Compare comp = {}) {
+    std::iter_swap(choosePivot(first, last, comp), last - 1);
+    return twoWayPartition(first, last, scheme, comp);
+}
+
+// introPartition of arr[low..high]; returns the pivot's final index
+template <typename T>
+int introPartition(std::vector<T>& arr, int low, int high, PartitionScheme scheme = PartitionScheme::Lomuto) {
+    return introPartition(arr.begin() + low, arr.begin() + high + 1, scheme) - arr.begin();
+}
+
+// floor(log2(n)) for n >= 1
+inline int floorLog2(long n) {
+    int log = 0;
+    while (n > 1) {
+        n >>= 1;
+        ++log;
+    }
+    return log;
+}
+
+// Recurse on the smaller side and loop on the larger one, so the stack stays O(log n)
+template <typename It, typename Compare>
+void introSortLoop(It first, It last, int depthLimit, int threshold, PartitionScheme scheme, Compare comp) {
+    while (last - first > threshold) {
+        if (depthLimit == 0) {
+            // Too many bad pivots: finish this range with Heap Sort
+            heapSort(first, last, comp);
+            return;
+        }
+        --depthLimit;
+        // [lt, gt) is the block of keys already in their final place
+        It lt, gt;
+        if (scheme == PartitionScheme::ThreeWay) {
+            std::iter_swap(choosePivot(first, last, comp), last - 1);
+            std::tie(lt, gt) = threeWayPartition(first, last, comp);
+        } else {
+            lt = introPartition(first, last, scheme, comp);
+            gt = lt + 1;
+        }
+        if (lt - first < last - gt) {
+            introSortLoop(first, lt, depthLimit, threshold, scheme, comp);
+            first = gt;
+        } else {
+            introSortLoop(gt, last, depthLimit, threshold, scheme, comp);
+            last = lt;
+        }
+    }
+    // Use a sorting network or Insertion Sort for small subarrays
+    smallSort(first, last, comp);
+}
+
+// Intro Sort of [first, last) by `comp`: Quick Sort with median-of-three/ninther pivots,
+// a Heap Sort fallback after 2*log2(n) levels and smallSort below `threshold`;
+// O(n log n) in the worst case
+template <typename It, typename Compare = std::less<>>
+    requires std::random_access_iterator<It>
+void introSort(It first, It last, Compare comp = {}, int threshold = 10,
+               PartitionScheme scheme = PartitionScheme::Lomuto) {
+    if (last - first < 2) return;
+    introSortLoop(first, last, 2 * floorLog2(last - first), threshold, scheme, comp);
+}
+
+// Intro Sort of arr[low..high]
+template <typename T>
+void introSort(std::vector<T>& arr, int low, int high, int threshold = 10,
+               PartitionScheme scheme = PartitionScheme::Lomuto) {
+    if (low >= high) return;
+    introSort(arr.begin() + low, arr.begin() + high + 1, std::less<>(), threshold, scheme);
+}
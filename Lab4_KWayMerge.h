@@ -0,0 +1,268 @@
+#pragma once
+
+#include <algorithm>
+#include <array>
+#include <cstddef>
+#include <functional>
+#include <iterator>
+#include <ranges>
+#include <utility>
+#include <vector>
+
+// Tournament tree of losers over k sorted sources (Knuth, TAOCP 5.4.1). Every internal
+// node keeps the loser of the match played there and node 0 the overall winner, so
+// replacing the winner's key replays only the log2(k) matches on its path, one comparison
+// per level instead of a binary heap's two.
+// Exhausted sources lose every match; ties go to the lower source index, so merging runs
+// given in their original order is stable.
+template <typename T, typename Compare = std::less<>>
+class LoserTree {
+public:
+    explicit LoserTree(size_t k, Compare comp = {})
+        : keys(k), live(k, 0), tree(std::max<size_t>(k, 1), 0), comp(comp) {}
+
+    size_t size() const { return keys.size(); }
+
+    // First key of `source`, set before build(); sources never set start exhausted
+    void set(size_t source, T key) {
+        keys[source] = std::move(key);
+        live[source] = 1;
+    }
+
+    // Play every match once: k - 1 comparisons
+    void build() {
+        size_t k = keys.size();
+        if (k == 0) return;
+        // Leaves are nodes k..2k-1 and node n plays the winners of 2n and 2n + 1
+        std::vector<size_t> winners(2 * k);
+        for (size_t i = 0; i < k; ++i) winners[k + i] = i;
+        for (size_t node = k - 1; node > 0; --node) {
+            size_t a = winners[2 * node];
+            size_t b = winners[2 * node + 1];
+            bool aWins = beats(a, b);
+            winners[node] = aWins ? a : b;
+            tree[node] = aWins ? b : a;
+        }
+        tree[0] = k == 1 ? 0 : winners[1];
+    }
+
+    // True once every source is exhausted
+    bool empty() const { return keys.empty() || !live[tree[0]]; }
+
+    // Source holding the smallest key, and that key
+    size_t winner() const { return tree[0]; }
+    const T& top() const { return keys[tree[0]]; }
+    T& top() { return keys[tree[0]]; }
+
+    // The winner's source moved on to `key`
+    void replace(T key) {
+        keys[tree[0]] = std::move(key);
+        replay();
+    }
+
+    // The winner's source is exhausted
+    void remove() {
+        live[tree[0]] = 0;
+        replay();
+    }
+
+private:
+    // Whether source a wins against source b: the smaller key, or the lower source on a tie.
+    // One comparison does both: the higher source wins only if its key is strictly smaller.
+    // Exhausted sources are rare and predictable; the key comparison is a coin flip on
+    // random data, so it is not branched on.
+    bool beats(size_t a, size_t b) const {
+        if (!(live[a] & live[b])) return live[a] || (!live[b] && a < b);
+        bool lower = a < b;
+        size_t high = lower ? b : a;
+        size_t low = lower ? a : b;
+        return comp(keys[high], keys[low]) ^ lower;
+    }
+
+    // Replay the matches from the winner's leaf to the root. The swap goes through a mask,
+    // as the compiler turns a conditional swap back into a branch.
+    void replay() {
+        size_t k = keys.size();
+        size_t candidate = tree[0];
+        for (size_t node = (candidate + k) / 2; node > 0; node /= 2) {
+            size_t loser = tree[node];
+            size_t swap = (loser ^ candidate) & (size_t(0) - beats(loser, candidate));
+            tree[node] = loser ^ swap;
+            candidate ^= swap;
+        }
+        tree[0] = candidate;
+    }
+
+    std::vector<T> keys;       // current key of every source
+    std::vector<char> live;    // 0 once a source is exhausted
+    std::vector<size_t> tree;  // tree[n] = loser at node n, tree[0] = winner
+    Compare comp;
+};
+
+// Branchless merge of two to four non-empty runs [first, last) into `out` by moving.
+// While every run has elements, each output element costs k - 1 comparisons in a fixed
+// tournament whose outcomes select the cursor to read and advance, with no jumps; the
+// cursors live in locals, as going through an array puts a store and a load on the
+// critical path of every step. When a run empties (rare and predictable) it leaves and
+// the others go on with one way fewer. Ties go to the lower run, so the merge is stable.
+// Returns the end of the output.
+template <typename It, typename Out, typename Compare>
+Out smallKWayMerge(std::vector<std::pair<It, It>> runs, Out out, Compare comp) {
+    while (runs.size() > 1) {
+        if (runs.size() == 4) {
+            It c0 = runs[0].first, e0 = runs[0].second;
+            It c1 = runs[1].first, e1 = runs[1].second;
+            It c2 = runs[2].first, e2 = runs[2].second;
+            It c3 = runs[3].first, e3 = runs[3].second;
+            while (c0 != e0 && c1 != e1 && c2 != e2 && c3 != e3) {
+                bool x1 = comp(*c1, *c0);
+                It x = x1 ? c1 : c0;
+                bool y3 = comp(*c3, *c2);
+                It y = y3 ? c3 : c2;
+                bool takeY = comp(*y, *x);
+                *out = std::move(takeY ? *y : *x);
+                ++out;
+                c0 += !takeY & !x1;
+                c1 += !takeY & x1;
+                c2 += takeY & !y3;
+                c3 += takeY & y3;
+            }
+            runs = {{c0, e0}, {c1, e1}, {c2, e2}, {c3, e3}};
+        } else if (runs.size() == 3) {
+            It c0 = runs[0].first, e0 = runs[0].second;
+            It c1 = runs[1].first, e1 = runs[1].second;
+            It c2 = runs[2].first, e2 = runs[2].second;
+            while (c0 != e0 && c1 != e1 && c2 != e2) {
+                bool x1 = comp(*c1, *c0);
+                It x = x1 ? c1 : c0;
+                bool take2 = comp(*c2, *x);
+                *out = std::move(take2 ? *c2 : *x);
+                ++out;
+                c0 += !take2 & !x1;
+                c1 += !take2 & x1;
+                c2 += take2;
+            }
+            runs = {{c0, e0}, {c1, e1}, {c2, e2}};
+        } else {
+            It c0 = runs[0].first, e0 = runs[0].second;
+            It c1 = runs[1].first, e1 = runs[1].second;
+            while (c0 != e0 && c1 != e1) {
+                bool take1 = comp(*c1, *c0);
+                *out = std::move(take1 ? *c1 : *c0);
+                ++out;
+                c0 += !take1;
+                c1 += take1;
+            }
+            runs = {{c0, e0}, {c1, e1}};
+        }
+        std::erase_if(runs, [](const std::pair<It, It>& run) { return run.first == run.second; });
+    }
+    if (!runs.empty()) out = std::move(runs[0].first, runs[0].second, out);
+    return out;
+}
+
+// Merge non-empty runs [first, last) into `out` by moving, in one pass: the branchless
+// merge for up to four runs, a loser tree above that. Stable. Returns the end of the output.
+template <typename It, typename Out, typename Compare>
+Out kWayMergeRuns(std::vector<std::pair<It, It>> runs, Out out, Compare comp) {
+    size_t k = runs.size();
+    if (k == 0) return out;
+    if (k == 1) return std::move(runs[0].first, runs[0].second, out);
+    if (k <= 4) return smallKWayMerge(std::move(runs), out, comp);
+
+    LoserTree<std::iter_value_t<It>, Compare> tree(k, comp);
+    for (size_t i = 0; i < k; ++i) {
+        tree.set(i, std::move(*runs[i].first));
+        ++runs[i].first;
+    }
+    tree.build();
+    while (!tree.empty()) {
+        auto& run = runs[tree.winner()];
+        *out = std::move(tree.top());
+        ++out;
+        if (run.first != run.second) {
+            tree.replace(std::move(*run.first));
+            ++run.first;
+        } else {
+            tree.remove();
+        }
+    }
+    return out;
+}
+
+// The non-empty runs of a range of sorted ranges as [first, last) pairs
+template <typename Runs>
+auto runBounds(Runs& runs) {
+    using It = std::ranges::iterator_t<std::ranges::range_reference_t<Runs>>;
+    std::vector<std::pair<It, It>> bounds;
+    for (auto&& run : runs) {
+        auto first = std::ranges::begin(run);
+        auto last = std::ranges::next(first, std::ranges::end(run));
+        if (first != last) bounds.emplace_back(first, last);
+    }
+    return bounds;
+}
+
+// K-way merge of pre-sorted shards: every range of `runs` (a vector<vector<T>>, a
+// vector<span<T>>, ...) is sorted by `comp` and is merged into `out` by moving, in one
+// pass instead of log2(k) passes of two-way merges. Stable: ties go to the earlier run.
+// Returns the end of the output.
+template <typename Runs, typename Out, typename Compare = std::less<>>
+    requires std::ranges::forward_range<std::ranges::range_reference_t<Runs>>
+Out kWayMerge(Runs&& runs, Out out, Compare comp = {}) {
+    return kWayMergeRuns(runBounds(runs), out, comp);
+}
+
+// K-way merge of sorted streams through a loser tree. next(i, value) reads the next
+// element of stream i into `value` and returns false at its end (RunReader::next fits);
+// sink(value) receives the merged elements in order. Stable across streams.
+template <typename T, typename NextFn, typename Sink, typename Compare = std::less<>>
+void mergeStreams(size_t k, NextFn next, Sink sink, Compare comp = {}) {
+    LoserTree<T, Compare> tree(k, comp);
+    T value;
+    for (size_t i = 0; i < k; ++i) {
+        if (next(i, value)) tree.set(i, std::move(value));
+    }
+    tree.build();
+    while (!tree.empty()) {
+        sink(std::move(tree.top()));
+        if (next(tree.winner(), value)) tree.replace(std::move(value));
+        else tree.remove();
+    }
+}
+
+// Multi-way co-rank: how many of the first `rank` elements of the stable merge of the
+// runs come from each run. A candidate from the widest remaining window is ranked by a
+// binary search in every window, and the windows shrink to the side the target lies on;
+// each step halves the widest window, so O(k log n) steps of k searches.
+template <typename It, typename Compare>
+std::vector<size_t> kWayCoRank(const std::vector<std::pair<It, It>>& runs, size_t rank, Compare comp) {
+    size_t k = runs.size();
+    std::vector<size_t> low(k, 0), high(k), count(k);
+    for (size_t i = 0; i < k; ++i) high[i] = runs[i].second - runs[i].first;
+    while (k > 0) {
+        size_t widest = 0;
+        for (size_t i = 1; i < k; ++i) {
+            if (high[i] - low[i] > high[widest] - low[widest]) widest = i;
+        }
+        if (high[widest] == low[widest]) break;
+        size_t mid = low[widest] + (high[widest] - low[widest]) / 2;
+        const auto& candidate = runs[widest].first[mid];
+        // Elements ahead of the candidate: equal keys of earlier runs come first
+        size_t ahead = 0;
+        for (size_t i = 0; i < k; ++i) {
+            It first = runs[i].first;
+            if (i < widest) count[i] = std::upper_bound(first + low[i], first + high[i], candidate, comp) - first;
+            else if (i > widest) count[i] = std::lower_bound(first + low[i], first + high[i], candidate, comp) - first;
+            else count[i] = mid;
+            ahead += count[i];
+        }
+        if (ahead < rank) {
+            low = count;  // the candidate and everything ahead of it are among the first `rank`
+            ++low[widest];
+        } else {
+            high = count;
+        }
+    }
+    return low;
+}
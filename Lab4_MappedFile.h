@@ -0,0 +1,366 @@
+#pragma once
+
+#include <algorithm>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <iostream>
+#include <ranges>
+#include <span>
+#include <string>
+#include <vector>
+#include "Lab4_Benchmark.h"
+#include "Lab4_Ranges.h"
+
+#if defined(__unix__) || defined(__APPLE__)
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+// File mode of the sort drivers: a binary file of fixed-width keys (or of fixed-size
+// records with a key at some offset) is memory-mapped and sorted where it lies, so
+// production dumps sort with no parsing and no copy into a vector.
+
+// How a mapping is about to be accessed, passed on to the kernel's readahead
+enum class AccessHint {
+    Normal,
+    Sequential,  // read ahead aggressively, pages behind the scan may be dropped
+    Random,      // no readahead: gathers and permutations jump around
+    WillNeed     // start reading the whole range in now
+};
+
+// A file mapped into memory, shared with the file so every write reaches it.
+// isOpen() is false when the file cannot be opened or mapped, or on systems without mmap.
+class MappedFile {
+public:
+    MappedFile() = default;
+
+    // Map an existing file, read-only or writable
+    MappedFile(const std::string& path, bool writable) {
+#if defined(__unix__) || defined(__APPLE__)
+        fd = ::open(path.c_str(), writable ? O_RDWR : O_RDONLY);
+        struct stat info;
+        if (fd < 0 || ::fstat(fd, &info) != 0) {
+            std::cerr << "Cannot open " << path << (writable ? " for writing" : " for reading") << std::endl;
+            close();
+            return;
+        }
+        bytes = static_cast<size_t>(info.st_size);
+        map(path, writable);
+#else
+        std::cerr << "Cannot map " << path << ": memory-mapped files are not supported here" << std::endl;
+#endif
+    }
+
+    // Create (or truncate) `path` with `size` bytes and map it writable
+    static MappedFile create(const std::string& path, size_t size) {
+        MappedFile file;
+#if defined(__unix__) || defined(__APPLE__)
+        file.fd = ::open(path.c_str(), O_RDWR | O_CREAT | O_TRUNC, 0644);
+        if (file.fd < 0 || ::ftruncate(file.fd, static_cast<off_t>(size)) != 0) {
+            std::cerr << "Cannot open " << path << " for writing" << std::endl;
+            file.close();
+            return file;
+        }
+        file.bytes = size;
+        file.map(path, true);
+#else
+        std::cerr << "Cannot map " << path << ": memory-mapped files are not supported here" << std::endl;
+#endif
+        return file;
+    }
+
+    ~MappedFile() { close(); }
+
+    MappedFile(MappedFile&& other) noexcept { *this = std::move(other); }
+    MappedFile& operator=(MappedFile&& other) noexcept {
+        if (this != &other) {
+            close();
+            std::swap(fd, other.fd);
+            std::swap(address, other.address);
+            std::swap(bytes, other.bytes);
+        }
+        return *this;
+    }
+    MappedFile(const MappedFile&) = delete;
+    MappedFile& operator=(const MappedFile&) = delete;
+
+    bool isOpen() const { return fd >= 0; }
+    size_t size() const { return bytes; }
+    std::byte* data() const { return static_cast<std::byte*>(address); }
+
+    // The file as whole elements of T; a trailing partial element is left out
+    template <typename T>
+    std::span<T> as() const {
+        return std::span<T>(reinterpret_cast<T*>(address), bytes / sizeof(T));
+    }
+
+    // Tell the kernel how the mapping is about to be accessed
+    void advise(AccessHint hint) const {
+#if defined(__unix__) || defined(__APPLE__)
+        if (!address) return;
+        int advice = hint == AccessHint::Sequential ? POSIX_MADV_SEQUENTIAL
+                   : hint == AccessHint::Random     ? POSIX_MADV_RANDOM
+                   : hint == AccessHint::WillNeed   ? POSIX_MADV_WILLNEED
+                                                    : POSIX_MADV_NORMAL;
+        posix_madvise(address, bytes, advice);
+#else
+        (void)hint;
+#endif
+    }
+
+    // Write dirty pages back to the file and wait for them; false on an I/O error
+    bool sync() const {
+#if defined(__unix__) || defined(__APPLE__)
+        return !address || ::msync(address, bytes, MS_SYNC) == 0;
+#else
+        return false;
+#endif
+    }
+
+private:
+#if defined(__unix__) || defined(__APPLE__)
+    void map(const std::string& path, bool writable) {
+        if (bytes == 0) return;  // mmap rejects empty mappings; there is nothing to sort anyway
+        int protection = writable ? PROT_READ | PROT_WRITE : PROT_READ;
+        void* mapped = ::mmap(nullptr, bytes, protection, MAP_SHARED, fd, 0);
+        if (mapped == MAP_FAILED) {
+            std::cerr << "Cannot map " << path << std::endl;
+            close();
+            return;
+        }
+        address = mapped;
+    }
+#endif
+
+    void close() {
+#if defined(__unix__) || defined(__APPLE__)
+        if (address) ::munmap(address, bytes);
+        if (fd >= 0) ::close(fd);
+#endif
+        address = nullptr;
+        bytes = 0;
+        fd = -1;
+    }
+
+    int fd = -1;
+    void* address = nullptr;
+    size_t bytes = 0;
+};
+
+// Key types of file mode
+enum class FileKeyType { Int32, Int64, Double };
+
+// Name of a key type, as given on the command line
+inline std::string fileKeyTypeName(FileKeyType type) {
+    switch (type) {
+        case FileKeyType::Int32: return "int32";
+        case FileKeyType::Int64: return "int64";
+        case FileKeyType::Double: return "double";
+    }
+    return "unknown";
+}
+
+// Parse "int32", "int64" or "double"; false for anything else
+inline bool parseFileKeyType(const std::string& name, FileKeyType& type) {
+    for (FileKeyType candidate : {FileKeyType::Int32, FileKeyType::Int64, FileKeyType::Double}) {
+        if (fileKeyTypeName(candidate) == name) {
+            type = candidate;
+            return true;
+        }
+    }
+    return false;
+}
+
+// Call func(T{}) with a value of the C++ type behind `type`
+template <typename Func>
+void withFileKeyType(FileKeyType type, Func func) {
+    switch (type) {
+        case FileKeyType::Int32: func(int32_t{}); break;
+        case FileKeyType::Int64: func(int64_t{}); break;
+        case FileKeyType::Double: func(double{}); break;
+    }
+}
+
+// Sort engines file mode can run, by name
+inline const std::vector<std::string>& fileSortEngines() {
+    static const std::vector<std::string> engines = {"intro", "merge", "heap", "radix", "adaptive",
+                                                     "parallel-quick", "parallel-merge"};
+    return engines;
+}
+
+// Sort mapped keys in place with the named engine; false for an unknown name
+template <typename T>
+bool sortKeys(std::span<T> keys, const std::string& engine, ThreadPool& pool) {
+    if (engine == "intro") introSort(keys);
+    else if (engine == "merge") bufferedMergeSort(keys);
+    else if (engine == "heap") heapSort(keys);
+    else if (engine == "radix") lsdRadixSort(keys);
+    else if (engine == "adaptive") adaptiveSort(keys);
+    else if (engine == "parallel-quick") parallelQuickSort(keys, pool);
+    else if (engine == "parallel-merge") parallelMergeSort(keys, pool);
+    else return false;
+    return true;
+}
+
+// The key of record `index`, read byte-wise since records need not keep it aligned
+template <typename T>
+T recordKey(const std::byte* records, size_t recordSize, size_t keyOffset, size_t index) {
+    T key;
+    std::memcpy(&key, records + index * recordSize + keyOffset, sizeof(T));
+    return key;
+}
+
+// Stable sorting permutation of `count` records by their key: the radix-sorted
+// (prefix, index) entries of an Index Sort, with the record index as the element
+template <typename T>
+std::vector<size_t> recordPermutation(const std::byte* records, size_t count, size_t recordSize, size_t keyOffset) {
+    auto indices = std::views::iota(size_t(0), count);
+    auto key = [=](size_t index) { return recordKey<T>(records, recordSize, keyOffset, index); };
+    return sortPermutation(indices.begin(), indices.end(), [&key](size_t index) { return keyPrefix(key(index)); },
+                           [&key](size_t a, size_t b) { return key(a) < key(b); }, true);
+}
+
+// applyPermutation for records of recordSize bytes: the new record i is the old record
+// perm[i]. Every record is copied once, plus one copy per cycle. perm is left as the identity.
+inline void permuteRecords(std::byte* records, size_t recordSize, std::vector<size_t>& perm) {
+    std::vector<std::byte> temp(recordSize);
+    for (size_t start = 0; start < perm.size(); ++start) {
+        if (perm[start] == start) continue;
+        std::memcpy(temp.data(), records + start * recordSize, recordSize);
+        size_t current = start;
+        while (true) {
+            size_t next = perm[current];
+            perm[current] = current;
+            if (next == start) {
+                std::memcpy(records + current * recordSize, temp.data(), recordSize);
+                break;
+            }
+            std::memcpy(records + current * recordSize, records + next * recordSize, recordSize);
+            current = next;
+        }
+    }
+}
+
+// Whether `count` records are in key order
+template <typename T>
+bool recordsSorted(const std::byte* records, size_t count, size_t recordSize, size_t keyOffset) {
+    for (size_t i = 1; i < count; ++i) {
+        if (recordKey<T>(records, recordSize, keyOffset, i) < recordKey<T>(records, recordSize, keyOffset, i - 1)) {
+            return false;
+        }
+    }
+    return true;
+}
+
+// File mode of a sort driver: map config.inputPath and sort it with config.sortEngine
+// (`defaultEngine` when none was given), in place or, with config.outputPath, into a
+// second mapping. Records (config.recordSize > 0) are Index Sorted by the key at
+// config.keyOffset, moving every record once. Prints the time and throughput, adds the
+// result to `results` and returns false on any error.
+inline bool sortFile(const BenchmarkConfig& config, const std::string& defaultEngine,
+                     std::vector<BenchmarkResult>& results) {
+    FileKeyType type;
+    if (!parseFileKeyType(config.keyType, type)) {
+        std::cerr << "Unknown key type " << config.keyType << " (int32, int64 or double)" << std::endl;
+        return false;
+    }
+    std::string engine = config.sortEngine.empty() ? defaultEngine : config.sortEngine;
+    if (std::find(fileSortEngines().begin(), fileSortEngines().end(), engine) == fileSortEngines().end()) {
+        std::cerr << "Unknown sort engine " << engine << std::endl;
+        return false;
+    }
+    bool inPlace = config.outputPath.empty() || config.outputPath == config.inputPath;
+    size_t recordSize = static_cast<size_t>(config.recordSize);
+    size_t keyOffset = static_cast<size_t>(config.keyOffset);
+
+    MappedFile input(config.inputPath, inPlace);
+    if (!input.isOpen()) return false;
+    ThreadPool pool(config.threads);
+    bool ok = true;
+    bool sorted = true;
+    size_t count = 0;
+    auto start = std::chrono::steady_clock::now();
+    auto stop = start;  // taken before the result is verified, which is not part of the sort
+    withFileKeyType(type, [&](auto key) {
+        using T = decltype(key);
+        // The mapping is sorted as whole keys or records, so a partial one at the end would be lost
+        size_t unit = recordSize == 0 ? sizeof(T) : recordSize;
+        if (input.size() % unit != 0) {
+            std::cerr << config.inputPath << " holds " << input.size() << " bytes, not a whole number of "
+                      << unit << "-byte " << (recordSize == 0 ? "keys" : "records") << std::endl;
+            ok = false;
+            return;
+        }
+        if (recordSize == 0) {
+            // Bare keys: sort the mapping itself, or a copy of it in the output mapping
+            MappedFile output;
+            std::span<T> keys = input.as<T>();
+            if (!inPlace) {
+                output = MappedFile::create(config.outputPath, keys.size_bytes());
+                if (!output.isOpen()) {
+                    ok = false;
+                    return;
+                }
+                input.advise(AccessHint::Sequential);
+                output.advise(AccessHint::Sequential);
+                if (!keys.empty()) std::memcpy(output.data(), input.data(), keys.size_bytes());
+                keys = output.as<T>();
+            }
+            MappedFile& target = inPlace ? input : output;
+            target.advise(AccessHint::WillNeed);
+            sortKeys(keys, engine, pool);
+            ok = target.sync();
+            stop = std::chrono::steady_clock::now();
+            count = keys.size();
+            sorted = std::ranges::is_sorted(keys);
+        } else {
+            if (keyOffset + sizeof(T) > recordSize) {
+                std::cerr << "The key does not fit in a " << recordSize << "-byte record" << std::endl;
+                ok = false;
+                return;
+            }
+            // Records: the keys are read in one sequential pass, the records then move once
+            count = input.size() / recordSize;
+            input.advise(AccessHint::Sequential);
+            std::vector<size_t> perm = recordPermutation<T>(input.data(), count, recordSize, keyOffset);
+            input.advise(AccessHint::Random);
+            const std::byte* records = input.data();
+            MappedFile output;
+            if (inPlace) {
+                permuteRecords(input.data(), recordSize, perm);
+                ok = input.sync();
+                stop = std::chrono::steady_clock::now();
+            } else {
+                output = MappedFile::create(config.outputPath, count * recordSize);
+                if (!output.isOpen()) {
+                    ok = false;
+                    return;
+                }
+                output.advise(AccessHint::Sequential);
+                for (size_t i = 0; i < count; ++i) {
+                    std::memcpy(output.data() + i * recordSize, input.data() + perm[i] * recordSize, recordSize);
+                }
+                ok = output.sync();
+                stop = std::chrono::steady_clock::now();
+                records = output.data();
+            }
+            sorted = recordsSorted<T>(records, count, recordSize, keyOffset);
+        }
+    });
+    if (!ok) return false;
+
+    double seconds = std::chrono::duration<double>(stop - start).count();
+    std::string what = recordSize == 0 ? fileKeyTypeName(type) + " keys" : std::to_string(recordSize) + "-byte records";
+    BenchmarkResult result = summarize("File " + (recordSize == 0 ? engine : std::string("index")) + " sort of " + what,
+                                       count, {seconds});
+    result.group = "file";
+    printResult(result);
+    results.push_back(result);
+    std::cout << config.inputPath << " -> " << (inPlace ? config.inputPath : config.outputPath) << ": "
+              << input.size() / 1048576.0 / seconds << " MB/s, " << (sorted ? "sorted" : "NOT SORTED") << std::endl;
+    return sorted;
+}
@@ -0,0 +1,259 @@
+#pragma once
+
+#include <algorithm>
+#include <concepts>
+#include <functional>
+#include <iterator>
+#include <utility>
+#include <vector>
+#include "Lab4_InsertionSort.h"
+#include "Lab4_SortingNetwork.h"
+
+// Move-merge the sorted runs [first1, last1) and [first2, last2) into `out`.
+// Ties take the element of the first run, so the merge is stable.
+template <typename In, typename Out, typename Compare>
+Out moveMerge(In first1, In last1, In first2, In last2, Out out, Compare comp) {
+    while (first1 != last1 && first2 != last2) {
+        if (comp(*first2, *first1)) *out++ = std::move(*first2++);
+        else *out++ = std::move(*first1++);
+    }
+    out = std::move(first1, last1, out);
+    return std::move(first2, last2, out);
+}
+
+template <typename It, typename Buf, typename Compare>
+void mergeSortInto(It first, It last, Buf out, int threshold, Compare comp);
+
+// Sort [first, last) in place, using the same number of slots at `buffer` as scratch.
+// The halves are sorted into the buffer and merged back, so each level moves every
+// element exactly once and nothing is copied or allocated.
+template <typename It, typename Buf, typename Compare>
+void mergeSortInPlace(It first, It last, Buf buffer, int threshold, Compare comp) {
+    auto n = last - first;
+    if (n <= threshold || n < 2) {
+        // Use a sorting network or Insertion Sort for small subarrays
+        smallSort(first, last, comp);
+        return;
+    }
+    It mid = first + n / 2;
+    mergeSortInto(first, mid, buffer, threshold, comp);
+    mergeSortInto(mid, last, buffer + n / 2, threshold, comp);
+    moveMerge(buffer, buffer + n / 2, buffer + n / 2, buffer + n, first, comp);
+}
+
+// Sort the elements of [first, last) into the same number of slots at `out`, leaving
+// [first, last) moved-from. The halves are sorted in place with `out` as their scratch.
+template <typename It, typename Buf, typename Compare>
+void mergeSortInto(It first, It last, Buf out, int threshold, Compare comp) {
+    auto n = last - first;
+    if (n <= threshold || n < 2) {
+        smallSort(out, std::move(first, last, out), comp);
+        return;
+    }
+    It mid = first + n / 2;
+    mergeSortInPlace(first, mid, out, threshold, comp);
+    mergeSortInPlace(mid, last, out + n / 2, threshold, comp);
+    moveMerge(first, mid, mid, last, out, comp);
+}
+
+// Merge Sort of [first, last) by `comp` with a caller-supplied scratch buffer.
+// The buffer only grows when it is smaller than the range, so a buffer reused across
+// calls makes the sort allocation-free; smallSort handles subarrays up to `threshold`.
+// Elements are only ever moved, so move-only types sort as well.
+template <typename It, typename Compare = std::less<>>
+    requires std::random_access_iterator<It>
+void bufferedMergeSort(It first, It last, std::vector<std::iter_value_t<It>>& buffer, Compare comp = {},
+                       int threshold = 1) {
+    auto n = last - first;
+    if (n < 2) return;
+    if (buffer.size() < static_cast<size_t>(n)) buffer.resize(n);
+    mergeSortInPlace(first, last, buffer.begin(), threshold, comp);
+}
+
+// Merge Sort of [first, last) with a single scratch buffer allocated up front
+template <typename It, typename Compare = std::less<>>
+    requires std::random_access_iterator<It> &&
+             std::predicate<Compare&, std::iter_reference_t<It>, std::iter_reference_t<It>>
+void bufferedMergeSort(It first, It last, Compare comp = {}, int threshold = 1) {
+    std::vector<std::iter_value_t<It>> buffer;
+    bufferedMergeSort(first, last, buffer, comp, threshold);
+}
+
+// Merge Sort of arr[left..right] with a reusable scratch buffer
+template <typename T>
+void bufferedMergeSort(std::vector<T>& arr, int left, int right, std::vector<T>& buffer, int threshold = 1) {
+    if (left >= right) return;
+    bufferedMergeSort(arr.begin() + left, arr.begin() + right + 1, buffer, std::less<>(), threshold);
+}
+
+// Merge Sort of arr[left..right] with a single scratch buffer allocated up front
+template <typename T>
+void bufferedMergeSort(std::vector<T>& arr, int left, int right, int threshold = 1) {
+    std::vector<T> buffer;
+    bufferedMergeSort(arr, left, right, buffer, threshold);
+}
+
+// First position in [first, last) whose element is greater than key.
+// Probes first+1, first+2, first+4, ... before the binary search, so it is
+// O(log d) when the answer is d elements away (TimSort's galloping).
+template <typename It, typename T, typename Compare = std::less<>>
+It gallopUpper(It first, It last, const T& key, Compare comp = {}) {
+    long bound = 1;
+    while (bound < last - first && !comp(key, first[bound])) bound *= 2;
+    return std::upper_bound(first + bound / 2, first + std::min<long>(bound, last - first), key, comp);
+}
+
+// First position in [first, last) whose element is not less than key, found by galloping
+template <typename It, typename T, typename Compare = std::less<>>
+It gallopLower(It first, It last, const T& key, Compare comp = {}) {
+    long bound = 1;
+    while (bound < last - first && comp(first[bound], key)) bound *= 2;
+    return std::lower_bound(first + bound / 2, first + std::min<long>(bound, last - first), key, comp);
+}
+
+// Consecutive wins by one side before the merge switches to galloping
+const int minGallop = 7;
+
+// Stable merge of the adjacent sorted runs [first, mid) and [mid, last).
+// Elements already in place at either end are skipped, the rest of the left run is moved
+// into `buffer`, and long winning streaks are moved in bulk after a galloping search.
+template <typename It, typename Buf, typename Compare>
+void mergeRuns(It first, It mid, It last, Buf buffer, Compare comp) {
+    // Left elements <= the first right element are already in place
+    first = gallopUpper(first, mid, *mid, comp);
+    if (first == mid) return;
+    // Right elements >= the last left element are already in place
+    last = gallopLower(mid, last, *(mid - 1), comp);
+
+    Buf i = buffer, bufferEnd = std::move(first, mid, buffer);
+    It j = mid, k = first;
+    int leftWins = 0, rightWins = 0;
+    while (i != bufferEnd && j != last) {
+        if (comp(*j, *i)) {
+            *k++ = std::move(*j++);
+            ++rightWins;
+            leftWins = 0;
+        } else {
+            *k++ = std::move(*i++);
+            ++leftWins;
+            rightWins = 0;
+        }
+        if (leftWins >= minGallop && j != last) {
+            // Move every left element <= *j at once
+            Buf end = gallopUpper(i, bufferEnd, *j, comp);
+            k = std::move(i, end, k);
+            i = end;
+            leftWins = 0;
+        } else if (rightWins >= minGallop && i != bufferEnd) {
+            // Move every right element < *i at once
+            It end = gallopLower(j, last, *i, comp);
+            k = std::move(j, end, k);
+            j = end;
+            rightWins = 0;
+        }
+    }
+    // Whatever is left of the right run is already in place
+    std::move(i, bufferEnd, k);
+}
+
+// TimSort's minimum run length: n itself below 64, otherwise a value in [32, 64]
+// chosen so n / minRun is close to a power of two and the final merges stay balanced
+inline long computeMinRun(long n) {
+    int r = 0;
+    while (n >= 64) {
+        r |= n & 1;
+        n >>= 1;
+    }
+    return n + r;
+}
+
+// Natural Merge Sort (TimSort-like) of [first, last) by `comp` without recursion.
+// Ascending runs are kept, strictly descending runs are reversed, runs shorter than
+// minRun are extended with Insertion Sort, and runs are merged from a stack that keeps
+// their lengths balanced. Sorted and nearly sorted input costs close to O(n).
+template <typename It, typename Compare = std::less<>>
+    requires std::random_access_iterator<It>
+void naturalMergeSort(It first, It last, std::vector<std::iter_value_t<It>>& buffer, Compare comp = {}) {
+    long n = last - first;
+    if (n < 2) return;
+    if (buffer.size() < static_cast<size_t>(n)) buffer.resize(n);
+    long minRun = computeMinRun(n);
+
+    // Pending runs; the length invariants keep the stack far below 64 entries
+    struct Run {
+        long start;
+        long length;
+    };
+    Run runs[64];
+    int stackSize = 0;
+
+    // Merge runs[at] with runs[at + 1]
+    auto mergeAt = [&](int at) {
+        Run& a = runs[at];
+        const Run& b = runs[at + 1];
+        mergeRuns(first + a.start, first + b.start, first + b.start + b.length, buffer.begin(), comp);
+        a.length += b.length;
+        if (at + 2 < stackSize) runs[at + 1] = runs[at + 2];
+        --stackSize;
+    };
+
+    long start = 0;
+    while (start < n) {
+        // Find the natural run starting at `start`
+        long end = start + 1;
+        if (end < n && comp(first[end], first[start])) {
+            while (end < n && comp(first[end], first[end - 1])) ++end;
+            std::reverse(first + start, first + end);
+        } else {
+            while (end < n && !comp(first[end], first[end - 1])) ++end;
+        }
+        // Extend short runs to minRun with Insertion Sort
+        if (end - start < minRun) {
+            end = std::min(n, start + minRun);
+            insertionSort(first + start, first + end, comp);
+        }
+        runs[stackSize++] = {start, end - start};
+        start = end;
+
+        // Restore the invariants len[i-2] > len[i-1] + len[i] and len[i-1] > len[i]
+        while (stackSize > 1) {
+            int at = stackSize - 2;
+            if ((at > 0 && runs[at - 1].length <= runs[at].length + runs[at + 1].length) ||
+                (at > 1 && runs[at - 2].length <= runs[at - 1].length + runs[at].length)) {
+                if (runs[at - 1].length < runs[at + 1].length) --at;
+            } else if (runs[at].length > runs[at + 1].length) {
+                break;
+            }
+            mergeAt(at);
+        }
+    }
+    // Merge everything that is left, newest runs first
+    while (stackSize > 1) {
+        int at = stackSize - 2;
+        if (at > 0 && runs[at - 1].length < runs[at + 1].length) --at;
+        mergeAt(at);
+    }
+}
+
+// Natural Merge Sort of [first, last) with a scratch buffer allocated up front
+template <typename It, typename Compare = std::less<>>
+    requires std::random_access_iterator<It> &&
+             std::predicate<Compare&, std::iter_reference_t<It>, std::iter_reference_t<It>>
+void naturalMergeSort(It first, It last, Compare comp = {}) {
+    std::vector<std::iter_value_t<It>> buffer;
+    naturalMergeSort(first, last, buffer, comp);
+}
+
+// Natural Merge Sort of arr[left..right] with a reusable scratch buffer
+template <typename T>
+void naturalMergeSort(std::vector<T>& arr, int left, int right, std::vector<T>& buffer) {
+    if (left >= right) return;
+    naturalMergeSort(arr.begin() + left, arr.begin() + right + 1, buffer);
+}
+
+// Natural Merge Sort of arr[left..right] with a scratch buffer allocated up front
+template <typename T>
+void naturalMergeSort(std::vector<T>& arr, int left, int right) {
+    std::vector<T> buffer;
+    naturalMergeSort(arr, left, right, buffer);
+}
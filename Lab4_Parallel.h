@@ -0,0 +1,345 @@
+#pragma once
+
+#include <algorithm>
+#include <atomic>
+#include <condition_variable>
+#include <deque>
+#include <functional>
+#include <iterator>
+#include <memory>
+#include <mutex>
+#include <ranges>
+#include <thread>
+#include <utility>
+#include <vector>
+#include "Lab4_IntroSort.h"
+#include "Lab4_KWayMerge.h"
+#include "Lab4_MergeSort.h"
+
+// Work-stealing thread pool. Every thread owns a task deque: it pushes and pops its own
+// tasks at the back (newest, cache-warm work first) and steals from the front of the other
+// deques (oldest, usually largest work) when its own is empty. Threads that are not workers,
+// such as main, share deque 0 and take part in the work while they wait for a TaskGroup.
+class ThreadPool {
+public:
+    // `threads` counts the calling thread, so threads - 1 workers are started
+    explicit ThreadPool(int threads = std::thread::hardware_concurrency()) {
+        threads = std::max(1, threads);
+        for (int i = 0; i < threads; ++i) queues.push_back(std::make_unique<WorkQueue>());
+        for (int i = 1; i < threads; ++i) workers.emplace_back([this, i] { workerLoop(i); });
+    }
+
+    ~ThreadPool() {
+        {
+            std::lock_guard<std::mutex> lock(sleepMutex);
+            stopping = true;
+        }
+        sleepCondition.notify_all();
+        for (auto& worker : workers) worker.join();
+    }
+
+    ThreadPool(const ThreadPool&) = delete;
+    ThreadPool& operator=(const ThreadPool&) = delete;
+
+    int threadCount() const { return queues.size(); }
+
+    // Queue a task on the calling thread's deque
+    void submit(std::function<void()> task) {
+        WorkQueue& queue = *queues[ownQueue()];
+        {
+            std::lock_guard<std::mutex> lock(queue.mutex);
+            queue.tasks.push_back(std::move(task));
+        }
+        pending.fetch_add(1);
+        {
+            // Taking the lock orders this wake-up after a sleeper's check of `pending`
+            std::lock_guard<std::mutex> lock(sleepMutex);
+        }
+        sleepCondition.notify_one();
+    }
+
+    // Run one queued task, our own newest first, otherwise one stolen from another thread.
+    // Returns false when every deque is empty.
+    bool runPendingTask() {
+        int self = ownQueue();
+        int n = queues.size();
+        std::function<void()> task;
+        for (int k = 0; k < n && !task; ++k) {
+            WorkQueue& queue = *queues[(self + k) % n];
+            std::lock_guard<std::mutex> lock(queue.mutex);
+            if (queue.tasks.empty()) continue;
+            if (k == 0) {
+                task = std::move(queue.tasks.back());
+                queue.tasks.pop_back();
+            } else {
+                task = std::move(queue.tasks.front());
+                queue.tasks.pop_front();
+            }
+        }
+        if (!task) return false;
+        pending.fetch_sub(1);
+        task();
+        return true;
+    }
+
+private:
+    struct WorkQueue {
+        std::mutex mutex;
+        std::deque<std::function<void()>> tasks;
+    };
+
+    // Index of the deque owned by the calling thread
+    int ownQueue() const { return currentPool == this ? currentQueue : 0; }
+
+    void workerLoop(int index) {
+        currentPool = this;
+        currentQueue = index;
+        while (true) {
+            if (runPendingTask()) continue;
+            std::unique_lock<std::mutex> lock(sleepMutex);
+            sleepCondition.wait(lock, [this] { return stopping || pending.load() > 0; });
+            if (stopping && pending.load() == 0) return;
+        }
+    }
+
+    std::vector<std::unique_ptr<WorkQueue>> queues;
+    std::vector<std::thread> workers;
+    std::atomic<int> pending{0};  // tasks queued but not yet started
+    std::mutex sleepMutex;
+    std::condition_variable sleepCondition;
+    bool stopping = false;
+
+    inline static thread_local const ThreadPool* currentPool = nullptr;
+    inline static thread_local int currentQueue = 0;
+};
+
+// A set of tasks to wait for. wait() runs queued tasks itself instead of blocking,
+// so nested groups inside tasks never deadlock the pool.
+class TaskGroup {
+public:
+    explicit TaskGroup(ThreadPool& pool) : pool(pool) {}
+    ~TaskGroup() { wait(); }
+
+    template <typename Func>
+    void run(Func func) {
+        remaining.fetch_add(1);
+        pool.submit([this, func]() mutable {
+            func();
+            remaining.fetch_sub(1, std::memory_order_release);
+        });
+    }
+
+    void wait() {
+        while (remaining.load(std::memory_order_acquire) > 0) {
+            if (!pool.runPendingTask()) std::this_thread::yield();
+        }
+    }
+
+private:
+    ThreadPool& pool;
+    std::atomic<int> remaining{0};
+};
+
+// Co-rank: how many of the first k merged elements come from a[0..m), the rest coming
+// from b[0..n). Ties go to `a`, matching a stable merge.
+template <typename It, typename Compare = std::less<>>
+long coRank(long k, It a, long m, It b, long n, Compare comp = {}) {
+    long low = std::max(0L, k - n), high = std::min(k, m);
+    while (low < high) {
+        long i = low + (high - low) / 2;
+        if (!comp(b[k - i - 1], a[i])) low = i + 1;
+        else high = i;
+    }
+    return low;
+}
+
+// Merge the sorted runs [first, mid) and [mid, last) into `out` by moving.
+// The output is cut into equal pieces whose input boundaries are found by co-ranking,
+// and every piece is merged independently by a task.
+template <typename In, typename Out, typename Compare>
+void parallelMerge(In first, In mid, In last, Out out, ThreadPool& pool, long cutoff, Compare comp) {
+    long m = mid - first, n = last - mid, total = m + n;
+    long pieces = std::min<long>(pool.threadCount() * 4L, std::max(1L, total / cutoff));
+    In a = first, b = mid;
+    TaskGroup group(pool);
+    for (long p = 0; p < pieces; ++p) {
+        group.run([=] {
+            long begin = total * p / pieces, end = total * (p + 1) / pieces;
+            long i1 = coRank(begin, a, m, b, n, comp), i2 = coRank(end, a, m, b, n, comp);
+            moveMerge(a + i1, a + i2, b + (begin - i1), b + (end - i2), out + begin, comp);
+        });
+    }
+    group.wait();
+}
+
+template <typename It, typename Buf, typename Compare>
+void parallelMergeSortInto(It first, It last, Buf out, ThreadPool& pool, long cutoff, int threshold, Compare comp);
+
+// Parallel version of mergeSortInPlace: the left half runs as a task while this thread
+// sorts the right half, then the halves are merged in parallel. Below `cutoff` elements
+// the sequential sort takes over.
+template <typename It, typename Buf, typename Compare>
+void parallelMergeSortInPlace(It first, It last, Buf buffer, ThreadPool& pool, long cutoff, int threshold,
+                              Compare comp) {
+    auto n = last - first;
+    if (n <= cutoff) {
+        mergeSortInPlace(first, last, buffer, threshold, comp);
+        return;
+    }
+    It mid = first + n / 2;
+    TaskGroup group(pool);
+    group.run([&] { parallelMergeSortInto(first, mid, buffer, pool, cutoff, threshold, comp); });
+    parallelMergeSortInto(mid, last, buffer + n / 2, pool, cutoff, threshold, comp);
+    group.wait();
+    parallelMerge(buffer, buffer + n / 2, buffer + n, first, pool, cutoff, comp);
+}
+
+// Parallel version of mergeSortInto
+template <typename It, typename Buf, typename Compare>
+void parallelMergeSortInto(It first, It last, Buf out, ThreadPool& pool, long cutoff, int threshold, Compare comp) {
+    auto n = last - first;
+    if (n <= cutoff) {
+        mergeSortInto(first, last, out, threshold, comp);
+        return;
+    }
+    It mid = first + n / 2;
+    TaskGroup group(pool);
+    group.run([&] { parallelMergeSortInPlace(first, mid, out, pool, cutoff, threshold, comp); });
+    parallelMergeSortInPlace(mid, last, out + n / 2, pool, cutoff, threshold, comp);
+    group.wait();
+    parallelMerge(first, mid, last, out, pool, cutoff, comp);
+}
+
+// Parallel Hybrid Merge Sort of [first, last) by `comp` (the Ex7 hybridSort spread over
+// the pool), with a caller-supplied scratch buffer. Stable.
+template <typename It, typename Compare = std::less<>>
+void parallelMergeSort(It first, It last, ThreadPool& pool, std::vector<std::iter_value_t<It>>& buffer,
+                       Compare comp = {}, long cutoff = 1 << 13, int threshold = 10) {
+    auto n = last - first;
+    if (n < 2) return;
+    if (buffer.size() < static_cast<size_t>(n)) buffer.resize(n);
+    parallelMergeSortInPlace(first, last, buffer.begin(), pool, std::max<long>(cutoff, threshold), threshold, comp);
+}
+
+// Parallel Hybrid Merge Sort of arr[left..right]
+template <typename T>
+void parallelMergeSort(std::vector<T>& arr, int left, int right, ThreadPool& pool,
+                       std::vector<T>& buffer, int cutoff = 1 << 13, int threshold = 10) {
+    if (left >= right) return;
+    parallelMergeSort(arr.begin() + left, arr.begin() + right + 1, pool, buffer, std::less<>(), cutoff, threshold);
+}
+
+// Merge non-empty sorted runs into `out` by moving. The output is cut into equal pieces
+// whose boundaries in every run are found by multi-way co-ranking, and every piece is
+// k-way merged independently by a task.
+template <typename It, typename Out, typename Compare>
+void parallelKWayMergeRuns(const std::vector<std::pair<It, It>>& runs, Out out, ThreadPool& pool, long cutoff,
+                           Compare comp) {
+    size_t total = 0;
+    for (const auto& run : runs) total += run.second - run.first;
+    size_t pieces = std::min<size_t>(pool.threadCount() * 4L, std::max<size_t>(1, total / std::max(1L, cutoff)));
+    if (pieces == 1) {
+        kWayMergeRuns(runs, out, comp);
+        return;
+    }
+    std::vector<std::vector<size_t>> cuts(pieces + 1);
+    TaskGroup ranking(pool);
+    for (size_t p = 0; p <= pieces; ++p) {
+        ranking.run([&, p] { cuts[p] = kWayCoRank(runs, total * p / pieces, comp); });
+    }
+    ranking.wait();
+    TaskGroup merging(pool);
+    for (size_t p = 0; p < pieces; ++p) {
+        merging.run([&, p] {
+            std::vector<std::pair<It, It>> slice;
+            for (size_t i = 0; i < runs.size(); ++i) {
+                if (cuts[p][i] < cuts[p + 1][i]) {
+                    slice.emplace_back(runs[i].first + cuts[p][i], runs[i].first + cuts[p + 1][i]);
+                }
+            }
+            kWayMergeRuns(std::move(slice), out + total * p / pieces, comp);
+        });
+    }
+    merging.wait();
+}
+
+// Parallel k-way merge of pre-sorted shards (a vector<vector<T>>, a vector<span<T>>, ...)
+// into `out` by moving. Stable: ties go to the earlier shard.
+template <typename Runs, typename Out, typename Compare = std::less<>>
+    requires std::ranges::random_access_range<std::ranges::range_reference_t<Runs>>
+void parallelKWayMerge(Runs&& runs, Out out, ThreadPool& pool, Compare comp = {}, long cutoff = 1 << 13) {
+    parallelKWayMergeRuns(runBounds(runs), out, pool, cutoff, comp);
+}
+
+// Parallel Merge Sort with a k-way final stage: one shard per thread is sorted into the
+// buffer, then all shards are merged back at once, every task producing one slice of the
+// output. Each element moves twice after the shard sorts, where the binary merge tree of
+// parallelMergeSort moves it once per level. Stable.
+template <typename It, typename Compare = std::less<>>
+void parallelKWayMergeSort(It first, It last, ThreadPool& pool, std::vector<std::iter_value_t<It>>& buffer,
+                           Compare comp = {}, long cutoff = 1 << 13, int threshold = 10) {
+    size_t n = last - first;
+    size_t shards = std::min<size_t>(pool.threadCount(), n / std::max(1L, cutoff));
+    if (shards <= 1) {
+        bufferedMergeSort(first, last, buffer, comp, threshold);
+        return;
+    }
+    if (buffer.size() < n) buffer.resize(n);
+    auto out = buffer.begin();
+    std::vector<std::pair<decltype(out), decltype(out)>> runs;
+    TaskGroup group(pool);
+    for (size_t s = 0; s < shards; ++s) {
+        size_t begin = n * s / shards, end = n * (s + 1) / shards;
+        runs.emplace_back(out + begin, out + end);
+        group.run([=] { mergeSortInto(first + begin, first + end, out + begin, threshold, comp); });
+    }
+    group.wait();
+    parallelKWayMergeRuns(runs, first, pool, cutoff, comp);
+}
+
+// Parallel K-Way Merge Sort of arr[left..right]
+template <typename T>
+void parallelKWayMergeSort(std::vector<T>& arr, int left, int right, ThreadPool& pool,
+                           std::vector<T>& buffer, int cutoff = 1 << 13, int threshold = 10) {
+    if (left >= right) return;
+    parallelKWayMergeSort(arr.begin() + left, arr.begin() + right + 1, pool, buffer, std::less<>(), cutoff,
+                          threshold);
+}
+
+template <typename It, typename Compare>
+void parallelQuickSortLoop(It first, It last, ThreadPool& pool, int depthLimit, long cutoff, int threshold,
+                           Compare comp) {
+    TaskGroup group(pool);
+    while (last - first > cutoff && depthLimit > 0) {
+        --depthLimit;
+        It pi = introPartition(first, last, PartitionScheme::Lomuto, comp);
+        // Hand the smaller side to the pool and keep partitioning the larger one
+        if (pi - first < last - pi) {
+            group.run([=, &pool] { parallelQuickSortLoop(first, pi, pool, depthLimit, cutoff, threshold, comp); });
+            first = pi + 1;
+        } else {
+            group.run([=, &pool] { parallelQuickSortLoop(pi + 1, last, pool, depthLimit, cutoff, threshold, comp); });
+            last = pi;
+        }
+    }
+    // Small ranges, and ranges with too many bad pivots, finish sequentially
+    introSort(first, last, comp, threshold);
+    group.wait();
+}
+
+// Parallel Hybrid Quick Sort of [first, last) by `comp` (the Ex8 hybridSort spread over the pool)
+template <typename It, typename Compare = std::less<>>
+void parallelQuickSort(It first, It last, ThreadPool& pool, Compare comp = {}, long cutoff = 1 << 13,
+                       int threshold = 10) {
+    if (last - first < 2) return;
+    parallelQuickSortLoop(first, last, pool, 2 * floorLog2(last - first), std::max<long>(cutoff, threshold),
+                          threshold, comp);
+}
+
+// Parallel Hybrid Quick Sort of arr[low..high]
+template <typename T>
+void parallelQuickSort(std::vector<T>& arr, int low, int high, ThreadPool& pool,
+                       int cutoff = 1 << 13, int threshold = 10) {
+    if (low >= high) return;
+    parallelQuickSort(arr.begin() + low, arr.begin() + high + 1, pool, std::less<>(), cutoff, threshold);
+}
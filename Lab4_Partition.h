@@ -0,0 +1,159 @@
+#pragma once
+
+#include <algorithm>
+#include <functional>
+#include <iterator>
+#include <utility>
+#include <vector>
+#include "Lab4_SimdPartition.h"
+
+// How Quick Sort splits a range around its pivot
+enum class PartitionScheme {
+    Lomuto,    // two parts: <= pivot and > pivot
+    ThreeWay,  // three parts: < pivot, == pivot and > pivot
+    Block,     // two parts, BlockQuicksort: branchless scans into offset buffers
+    Simd       // two parts, vector compress of int32/float/double keys (Block for other types)
+};
+
+// Keys scanned per side before BlockQuicksort swaps the misplaced ones
+const int partitionBlockSize = 64;
+
+// Every partition below takes its pivot from the last element of [first, last) and
+// compares through references to it, so no key is ever copied.
+
+// Dijkstra's three-way (Dutch national flag) partition around the pivot last[-1].
+// Returns {lt, gt} such that [first, lt) < pivot, [lt, gt) == pivot and
+// [gt, last) > pivot, so runs of equal keys drop out of the recursion.
+template <typename It, typename Compare = std::less<>>
+std::pair<It, It> threeWayPartition(It first, It last, Compare comp = {}) {
+    It pivot = last - 1;
+    // The pivot stays put while [first, pivot) is split, then joins the equal keys
+    It lt = first, gt = pivot, i = first;
+    while (i < gt) {
+        if (comp(*i, *pivot)) {
+            std::iter_swap(lt++, i++);
+        } else if (comp(*pivot, *i)) {
+            std::iter_swap(i, --gt);
+        } else {
+            ++i;
+        }
+    }
+    std::iter_swap(gt, pivot);
+    return {lt, gt + 1};
+}
+
+// Three-way partition of arr[low..high] around arr[high]; returns the inclusive
+// bounds {lt, gt} of the keys equal to the pivot
+template <typename T>
+std::pair<int, int> threeWayPartition(std::vector<T>& arr, int low, int high) {
+    auto [lt, gt] = threeWayPartition(arr.begin() + low, arr.begin() + high + 1);
+    return {static_cast<int>(lt - arr.begin()), static_cast<int>(gt - arr.begin()) - 1};
+}
+
+// Lomuto partition around the pivot last[-1]; returns the pivot's final position
+template <typename It, typename Compare = std::less<>>
+It lomutoPartition(It first, It last, Compare comp = {}) {
+    It pivot = last - 1;
+    It i = first;
+    for (It j = first; j < pivot; ++j) {
+        if (!comp(*pivot, *j)) {
+            std::iter_swap(i, j);
+            ++i;
+        }
+    }
+    std::iter_swap(i, pivot);
+    return i;
+}
+
+// BlockQuicksort partition (Edelkamp and Weiss) around the pivot last[-1].
+// Each side scans a block of keys and records the offsets of misplaced ones with
+// branchless stores; the recorded keys are then swapped pairwise. The comparisons
+// never decide a branch, so random keys cost no mispredictions. Keys equal to the
+// pivot may end up on either side. Returns the pivot's final position.
+template <typename It, typename Compare = std::less<>>
+It blockPartition(It first, It last, Compare comp = {}) {
+    const int block = partitionBlockSize;
+    It pivot = last - 1;
+    It left = first, right = pivot - 1;  // [left, right] is not partitioned yet
+    unsigned char offsetsLeft[block], offsetsRight[block];
+    int startLeft = 0, startRight = 0, numLeft = 0, numRight = 0;
+    while (right - left + 1 > 2 * block) {
+        if (numLeft == 0) {
+            startLeft = 0;
+            for (int i = 0; i < block; ++i) {
+                offsetsLeft[numLeft] = static_cast<unsigned char>(i);
+                numLeft += !comp(left[i], *pivot);
+            }
+        }
+        if (numRight == 0) {
+            startRight = 0;
+            for (int i = 0; i < block; ++i) {
+                offsetsRight[numRight] = static_cast<unsigned char>(i);
+                numRight += !comp(*pivot, *(right - i));
+            }
+        }
+        int num = std::min(numLeft, numRight);
+        for (int k = 0; k < num; ++k) {
+            std::iter_swap(left + offsetsLeft[startLeft + k], right - offsetsRight[startRight + k]);
+        }
+        numLeft -= num;
+        numRight -= num;
+        startLeft += num;
+        startRight += num;
+        if (numLeft == 0) left += block;
+        if (numRight == 0) right -= block;
+    }
+    // At most two blocks are left, including any half-finished one
+    It pi = left + branchlessPartition(left, right + 1, *pivot, comp);
+    std::iter_swap(pi, pivot);
+    return pi;
+}
+
+// Vectorized partition around the pivot last[-1] for int32/float/double keys in
+// plain ascending order, Block partition otherwise. Returns the pivot's final position.
+template <typename It, typename Compare = std::less<>>
+It simdPartition(It first, It last, Compare comp = {}) {
+    if constexpr (vectorizable<It, Compare> && hasSimdPartition<std::iter_value_t<It>>) {
+        auto* data = std::to_address(first);
+        It pi = first + simdPartitionKeys(data, data + (last - first - 1), last[-1]);
+        std::iter_swap(pi, last - 1);
+        return pi;
+    } else {
+        return blockPartition(first, last, comp);
+    }
+}
+
+// Two-way partition around the pivot last[-1] with the engine of `scheme`;
+// ThreeWay has its own interface and falls back to Lomuto here
+template <typename It, typename Compare = std::less<>>
+It twoWayPartition(It first, It last, PartitionScheme scheme, Compare comp = {}) {
+    switch (scheme) {
+        case PartitionScheme::Block: return blockPartition(first, last, comp);
+        case PartitionScheme::Simd: return simdPartition(first, last, comp);
+        default: return lomutoPartition(first, last, comp);
+    }
+}
+
+// Lomuto partition of arr[low..high] around arr[high]; returns the pivot's final index
+template <typename T>
+int lomutoPartition(std::vector<T>& arr, int low, int high) {
+    return lomutoPartition(arr.begin() + low, arr.begin() + high + 1) - arr.begin();
+}
+
+// Block partition of arr[low..high] around arr[high]; returns the pivot's final index
+template <typename T>
+int blockPartition(std::vector<T>& arr, int low, int high) {
+    return blockPartition(arr.begin() + low, arr.begin() + high + 1) - arr.begin();
+}
+
+// Vector partition of arr[low..high] around arr[high]; returns the pivot's final index
+template <typename T>
+int simdPartition(std::vector<T>& arr, int low, int high) {
+    return simdPartition(arr.begin() + low, arr.begin() + high + 1) - arr.begin();
+}
+
+// Two-way partition of arr[low..high] around arr[high]; returns the pivot's final index
+template <typename T>
+int twoWayPartition(std::vector<T>& arr, int low, int high, PartitionScheme scheme) {
+    return twoWayPartition(arr.begin() + low, arr.begin() + high + 1, scheme) - arr.begin();
+}
@@ -0,0 +1,298 @@
+#pragma once
+
+#include <algorithm>
+#include <cstddef>
+#include <functional>
+#include <iterator>
+#include <memory>
+#include <string>
+#include <type_traits>
+#include <utility>
+#include <vector>
+#include "Lab4_MergeSort.h"
+
+// How PoolList::sort orders its nodes
+enum class ListSortMode {
+    Auto,      // Merge for short lists, Gather from listGatherThreshold nodes on
+    Merge,     // bottom-up merge sort that relinks the nodes in place, no allocation
+    Prefetch,  // Merge, prefetching the node after each list head while comparing
+    Gather     // move the keys into an array, sort it there, relink the nodes in that order
+};
+
+// Human-readable name of a list sort mode
+inline std::string listSortModeName(ListSortMode mode) {
+    switch (mode) {
+        case ListSortMode::Auto: return "auto";
+        case ListSortMode::Merge: return "merge";
+        case ListSortMode::Prefetch: return "prefetch";
+        case ListSortMode::Gather: return "gather";
+    }
+    return "unknown";
+}
+
+// Lists at least this long are sorted by gathering the keys into an array: once the nodes
+// no longer fit in cache, every merge step of a list sort is a cache miss
+const size_t listGatherThreshold = 1 << 17;
+
+// Singly linked list whose nodes are carved out of contiguous slabs instead of being separate
+// heap allocations. Nodes built in order sit next to each other in memory, a push is a pointer
+// bump, and nodes that are popped are kept for the next push. Slabs double in size
+// up to poolSlabLimit nodes and are only released by the destructor.
+template <typename T>
+class PoolList {
+    struct Node {
+        template <typename... Args>
+        explicit Node(Args&&... args) : value(std::forward<Args>(args)...) {}
+
+        Node* next = nullptr;
+        T value;
+    };
+
+public:
+    static constexpr size_t poolSlabLimit = 1 << 16;
+
+    template <bool Const>
+    class Iterator {
+    public:
+        using iterator_category = std::forward_iterator_tag;
+        using value_type = T;
+        using difference_type = std::ptrdiff_t;
+        using pointer = std::conditional_t<Const, const T*, T*>;
+        using reference = std::conditional_t<Const, const T&, T&>;
+
+        Iterator() = default;
+        explicit Iterator(Node* node) : node(node) {}
+        operator Iterator<true>() const requires (!Const) { return Iterator<true>(node); }
+
+        reference operator*() const { return node->value; }
+        pointer operator->() const { return &node->value; }
+        Iterator& operator++() {
+            node = node->next;
+            return *this;
+        }
+        Iterator operator++(int) {
+            Iterator old = *this;
+            node = node->next;
+            return old;
+        }
+        bool operator==(const Iterator& other) const { return node == other.node; }
+
+    private:
+        Node* node = nullptr;
+    };
+
+    using value_type = T;
+    using iterator = Iterator<false>;
+    using const_iterator = Iterator<true>;
+
+    PoolList() = default;
+
+    template <typename It>
+    PoolList(It first, It last) {
+        for (; first != last; ++first) push_back(*first);
+    }
+
+    PoolList(const PoolList& other) {
+        reserve(other.count);
+        for (const T& value : other) push_back(value);
+    }
+
+    PoolList(PoolList&& other) noexcept { swap(other); }
+
+    PoolList& operator=(PoolList other) noexcept {
+        swap(other);
+        return *this;
+    }
+
+    ~PoolList() {
+        clear();
+        for (auto& [nodes, capacity] : slabs) std::allocator<Node>().deallocate(nodes, capacity);
+    }
+
+    void swap(PoolList& other) noexcept {
+        std::swap(head, other.head);
+        std::swap(tail, other.tail);
+        std::swap(count, other.count);
+        std::swap(freeNodes, other.freeNodes);
+        std::swap(slabs, other.slabs);
+        std::swap(slabUsed, other.slabUsed);
+    }
+
+    size_t size() const { return count; }
+    bool empty() const { return count == 0; }
+
+    iterator begin() { return iterator(head); }
+    iterator end() { return iterator(); }
+    const_iterator begin() const { return const_iterator(head); }
+    const_iterator end() const { return const_iterator(); }
+
+    T& front() { return head->value; }
+    const T& front() const { return head->value; }
+
+    // Make room for `n` more nodes in one slab, so a list built right after is contiguous
+    void reserve(size_t n) {
+        if (n > 0 && (slabs.empty() || slabs.back().second - slabUsed < n)) addSlab(n);
+    }
+
+    template <typename... Args>
+    T& emplace_back(Args&&... args) {
+        Node* node = allocate(std::forward<Args>(args)...);
+        if (tail) {
+            tail->next = node;
+        } else {
+            head = node;
+        }
+        tail = node;
+        return node->value;
+    }
+
+    template <typename... Args>
+    T& emplace_front(Args&&... args) {
+        Node* node = allocate(std::forward<Args>(args)...);
+        node->next = head;
+        head = node;
+        if (!tail) tail = node;
+        return node->value;
+    }
+
+    void push_back(const T& value) { emplace_back(value); }
+    void push_back(T&& value) { emplace_back(std::move(value)); }
+    void push_front(const T& value) { emplace_front(value); }
+    void push_front(T&& value) { emplace_front(std::move(value)); }
+
+    void pop_front() {
+        Node* node = head;
+        head = node->next;
+        if (!head) tail = nullptr;
+        release(node);
+    }
+
+    // Destroy every element; the slabs are kept for reuse
+    void clear() {
+        while (head) pop_front();
+    }
+
+    // Stable sort by `comp`; nodes are relinked, so iterators and references stay valid
+    template <typename Compare = std::less<>>
+    void sort(Compare comp = {}, ListSortMode mode = ListSortMode::Auto) {
+        if (count < 2) return;
+        if (mode == ListSortMode::Auto) {
+            mode = count >= listGatherThreshold ? ListSortMode::Gather : ListSortMode::Merge;
+        }
+        if (mode == ListSortMode::Gather) {
+            head = gatherSort(head, comp);
+        } else if (mode == ListSortMode::Prefetch) {
+            head = mergeSort<true>(head, comp);
+        } else {
+            head = mergeSort<false>(head, comp);
+        }
+        tail = head;
+        while (tail->next) tail = tail->next;
+    }
+
+private:
+    void addSlab(size_t capacity) {
+        slabs.emplace_back(std::allocator<Node>().allocate(capacity), capacity);
+        slabUsed = 0;
+    }
+
+    template <typename... Args>
+    Node* allocate(Args&&... args) {
+        Node* node;
+        if (!freeNodes.empty()) {
+            node = freeNodes.back();
+            freeNodes.pop_back();
+        } else {
+            if (slabs.empty() || slabUsed == slabs.back().second) {
+                addSlab(slabs.empty() ? 64 : std::min(2 * slabs.back().second, poolSlabLimit));
+            }
+            node = slabs.back().first + slabUsed++;
+        }
+        std::construct_at(node, std::forward<Args>(args)...);
+        ++count;
+        return node;
+    }
+
+    void release(Node* node) {
+        std::destroy_at(node);
+        freeNodes.push_back(node);
+        --count;
+    }
+
+    // Merge two sorted, null-terminated chains; ties take from `a`, which holds the earlier nodes
+    template <bool Prefetch, typename Compare>
+    static Node* mergeChains(Node* a, Node* b, Compare& comp) {
+        Node* merged = nullptr;
+        Node** link = &merged;
+        while (a && b) {
+            if constexpr (Prefetch) {
+                // The next node of either chain is needed one comparison from now
+                __builtin_prefetch(a->next);
+                __builtin_prefetch(b->next);
+            }
+            if (comp(b->value, a->value)) {
+                *link = b;
+                link = &b->next;
+                b = b->next;
+            } else {
+                *link = a;
+                link = &a->next;
+                a = a->next;
+            }
+        }
+        *link = a ? a : b;
+        return merged;
+    }
+
+    // Iterative bottom-up merge sort: bins[i] holds a sorted chain of 2^i nodes and every new
+    // node is carried up like a binary counter, so each merge works on recently touched nodes.
+    // Higher bins hold earlier nodes, which keeps the sort stable.
+    template <bool Prefetch, typename Compare>
+    static Node* mergeSort(Node* list, Compare& comp) {
+        Node* bins[64] = {};
+        int used = 0;
+        while (list) {
+            Node* carry = list;
+            list = list->next;
+            carry->next = nullptr;
+            int i = 0;
+            for (; bins[i]; ++i) {
+                carry = mergeChains<Prefetch>(bins[i], carry, comp);
+                bins[i] = nullptr;
+            }
+            bins[i] = carry;
+            used = std::max(used, i + 1);
+        }
+        Node* sorted = nullptr;
+        for (int i = 0; i < used; ++i) {
+            if (bins[i]) sorted = sorted ? mergeChains<Prefetch>(bins[i], sorted, comp) : bins[i];
+        }
+        return sorted;
+    }
+
+    // Move every key next to its node pointer in one array, sort the array with Natural Merge
+    // Sort (stable), then move the keys back and relink the nodes in sorted order. The sort's
+    // comparisons run over contiguous memory instead of chasing links.
+    template <typename Compare>
+    Node* gatherSort(Node* list, Compare& comp) {
+        std::vector<std::pair<T, Node*>> entries;
+        entries.reserve(count);
+        for (Node* node = list; node; node = node->next) entries.emplace_back(std::move(node->value), node);
+        naturalMergeSort(entries.begin(), entries.end(), [&comp](const auto& a, const auto& b) {
+            return comp(a.first, b.first);
+        });
+        for (size_t i = 0; i < entries.size(); ++i) {
+            Node* node = entries[i].second;
+            node->value = std::move(entries[i].first);
+            node->next = i + 1 < entries.size() ? entries[i + 1].second : nullptr;
+        }
+        return entries.front().second;
+    }
+
+    Node* head = nullptr;
+    Node* tail = nullptr;
+    size_t count = 0;
+    std::vector<Node*> freeNodes;                 // popped nodes, reused before the slabs grow
+    std::vector<std::pair<Node*, size_t>> slabs;  // storage and capacity of every slab
+    size_t slabUsed = 0;                          // nodes handed out from the last slab
+};
@@ -0,0 +1,189 @@
+#pragma once
+
+#include <cstdint>
+#include <cstring>
+#include <iterator>
+#include <utility>
+#include <vector>
+
+// Unsigned keys whose unsigned order matches the order of the original values.
+// Signed integers flip the sign bit; floating-point numbers flip the sign bit of
+// positives and every bit of negatives, which also orders -0.0 before +0.0.
+inline uint32_t radixKey(uint32_t x) { return x; }
+inline uint32_t radixKey(int32_t x) { return static_cast<uint32_t>(x) ^ 0x80000000u; }
+inline uint64_t radixKey(uint64_t x) { return x; }
+inline uint64_t radixKey(int64_t x) { return static_cast<uint64_t>(x) ^ 0x8000000000000000ull; }
+
+inline uint32_t radixKey(float x) {
+    uint32_t bits;
+    std::memcpy(&bits, &x, sizeof bits);
+    return (bits & 0x80000000u) ? ~bits : bits | 0x80000000u;
+}
+
+inline uint64_t radixKey(double x) {
+    uint64_t bits;
+    std::memcpy(&bits, &x, sizeof bits);
+    return (bits & 0x8000000000000000ull) ? ~bits : bits | 0x8000000000000000ull;
+}
+
+// radixKey of an element, the default key of the radix sorts below. Other key
+// functions, such as a projected or inverted key, must also return uint32_t or uint64_t.
+struct RadixKeyOf {
+    template <typename T>
+    auto operator()(const T& x) const {
+        return radixKey(x);
+    }
+};
+
+// Bits per radix digit; 256 counters per pass stay in L1 cache
+const int radixBits = 8;
+const int radixBuckets = 1 << radixBits;
+
+// LSD Radix Sort of [first, last) by the unsigned key `key(element)`, with a caller-supplied
+// buffer that grows to the length of the range when it is shorter.
+// All digit histograms are counted in a single read pass before any element moves, and
+// passes where every key has the same digit are skipped, so small bounded keys such as
+// [1, 1000] only need two scatter passes. Stable, O(n) per pass.
+template <typename It, typename KeyFn = RadixKeyOf>
+void lsdRadixSort(It first, It last, std::vector<std::iter_value_t<It>>& buffer, KeyFn key = {}) {
+    using Key = decltype(key(*first));
+    const int passes = sizeof(Key) * 8 / radixBits;
+    size_t n = last - first;
+    if (n < 2) return;
+    if (buffer.size() < n) buffer.resize(n);
+
+    std::vector<size_t> counts(passes * radixBuckets, 0);
+    for (It it = first; it != last; ++it) {
+        Key k = key(*it);
+        for (int p = 0; p < passes; ++p) {
+            ++counts[p * radixBuckets + ((k >> (p * radixBits)) & (radixBuckets - 1))];
+        }
+    }
+
+    // Scatter back and forth between the range and the buffer
+    bool inBuffer = false;
+    for (int p = 0; p < passes; ++p) {
+        size_t* count = &counts[p * radixBuckets];
+        int shift = p * radixBits;
+        // A digit shared by every key does not change the order
+        Key sample = inBuffer ? key(buffer[0]) : key(*first);
+        if (count[(sample >> shift) & (radixBuckets - 1)] == n) continue;
+
+        size_t offset = 0;
+        for (int b = 0; b < radixBuckets; ++b) {
+            size_t c = count[b];
+            count[b] = offset;
+            offset += c;
+        }
+        auto scatter = [&](auto src, auto dst) {
+            for (size_t i = 0; i < n; ++i) {
+                int digit = (key(src[i]) >> shift) & (radixBuckets - 1);
+                dst[count[digit]++] = std::move(src[i]);
+            }
+        };
+        if (inBuffer) scatter(buffer.begin(), first);
+        else scatter(first, buffer.begin());
+        inBuffer = !inBuffer;
+    }
+    // After an odd number of scatter passes the sorted keys sit in the buffer
+    if (inBuffer) {
+        std::move(buffer.begin(), buffer.begin() + n, first);
+    }
+}
+
+// LSD Radix Sort of arr[low..high] with a caller-supplied buffer
+template <typename T>
+void lsdRadixSort(std::vector<T>& arr, int low, int high, std::vector<T>& buffer) {
+    if (low >= high) return;
+    lsdRadixSort(arr.begin() + low, arr.begin() + high + 1, buffer);
+}
+
+// LSD Radix Sort of arr[low..high] with a buffer allocated up front
+template <typename T>
+void lsdRadixSort(std::vector<T>& arr, int low, int high) {
+    std::vector<T> buffer;
+    lsdRadixSort(arr, low, high, buffer);
+}
+
+// Insertion Sort of [first, last) by radix key, used for small MSD buckets
+template <typename It, typename KeyFn = RadixKeyOf>
+void radixInsertionSort(It first, It last, KeyFn key = {}) {
+    if (first == last) return;
+    for (It i = first + 1; i != last; ++i) {
+        auto value = std::move(*i);
+        auto k = key(value);
+        It j = i;
+        while (j != first && k < key(*(j - 1))) {
+            *j = std::move(*(j - 1));
+            --j;
+        }
+        *j = std::move(value);
+    }
+}
+
+// In-place MSD Radix Sort (American flag sort) of [first, last) on the digit at `shift`.
+// Each element is swapped straight into its bucket by following permutation cycles,
+// so no buffer is needed; buckets are then sorted on the next digit.
+template <typename It, typename KeyFn = RadixKeyOf>
+void americanFlagSort(It first, It last, int shift, KeyFn key = {}) {
+    while (true) {
+        size_t n = last - first;
+        if (n <= 32) {
+            radixInsertionSort(first, last, key);
+            return;
+        }
+        size_t count[radixBuckets] = {};
+        for (It it = first; it != last; ++it) {
+            ++count[(key(*it) >> shift) & (radixBuckets - 1)];
+        }
+        // All keys share this digit: go straight to the next one
+        size_t firstDigit = (key(*first) >> shift) & (radixBuckets - 1);
+        if (count[firstDigit] == n) {
+            if (shift == 0) return;
+            shift -= radixBits;
+            continue;
+        }
+
+        size_t head[radixBuckets], tail[radixBuckets];
+        size_t offset = 0;
+        for (int b = 0; b < radixBuckets; ++b) {
+            head[b] = offset;
+            offset += count[b];
+            tail[b] = offset;
+        }
+        for (int b = 0; b < radixBuckets; ++b) {
+            while (head[b] < tail[b]) {
+                auto value = std::move(first[head[b]]);
+                int digit = (key(value) >> shift) & (radixBuckets - 1);
+                while (digit != b) {
+                    std::swap(value, first[head[digit]++]);
+                    digit = (key(value) >> shift) & (radixBuckets - 1);
+                }
+                first[head[b]++] = std::move(value);
+            }
+        }
+        if (shift == 0) return;
+        It bucket = first;
+        for (int b = 0; b < radixBuckets; ++b) {
+            if (count[b] > 1) americanFlagSort(bucket, bucket + count[b], shift - radixBits, key);
+            bucket += count[b];
+        }
+        return;
+    }
+}
+
+// In-place MSD Radix Sort of [first, last) by `key(element)`; not stable, needs no buffer
+template <typename It, typename KeyFn = RadixKeyOf>
+    requires std::random_access_iterator<It>
+void msdRadixSort(It first, It last, KeyFn key = {}) {
+    using Key = decltype(key(*first));
+    if (last - first < 2) return;
+    americanFlagSort(first, last, sizeof(Key) * 8 - radixBits, key);
+}
+
+// In-place MSD Radix Sort of arr[low..high]
+template <typename T>
+void msdRadixSort(std::vector<T>& arr, int low, int high) {
+    if (low >= high) return;
+    msdRadixSort(arr.begin() + low, arr.begin() + high + 1);
+}
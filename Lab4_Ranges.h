@@ -0,0 +1,307 @@
+#pragma once
+
+#include <algorithm>
+#include <concepts>
+#include <cstdint>
+#include <functional>
+#include <iterator>
+#include <ranges>
+#include <type_traits>
+#include <vector>
+#include "Lab4_AdaptiveSort.h"
+#include "Lab4_CountingSort.h"
+#include "Lab4_Heap.h"
+#include "Lab4_IndexSort.h"
+#include "Lab4_InsertionSort.h"
+#include "Lab4_IntroSort.h"
+#include "Lab4_MergeSort.h"
+#include "Lab4_Parallel.h"
+#include "Lab4_RadixSort.h"
+#include "Lab4_Select.h"
+#include "Lab4_StringSort.h"
+
+// Range front ends for every engine, in the style of std::ranges::sort: any random-access
+// range (std::vector, std::array, std::deque, std::span over a raw buffer, a subrange)
+// plus a comparator and a projection, e.g.
+//     introSort(values, std::ranges::greater{});
+//     indexSort(records, {}, &Record::key);
+//     introSort(std::span(data + offset, count));
+// The engines index with the range's difference type, so ranges beyond 2^31 elements work.
+// Comparators and projections are template parameters and inline completely; with the
+// default ones, contiguous int32/float/double ranges keep their vector kernels.
+
+// A random-access range whose elements can be sorted by `Compare` after `Proj`
+template <typename R, typename Compare, typename Proj>
+concept SortableRange = std::ranges::random_access_range<R> && std::sortable<std::ranges::iterator_t<R>, Compare, Proj>;
+
+// The iterator one past the last element (ranges may end in a sentinel of another type)
+template <typename R>
+auto rangeEnd(R& range) {
+    return std::ranges::next(std::ranges::begin(range), std::ranges::end(range));
+}
+
+// Comparator that orders elements by comp(proj(a), proj(b)). The identity projection
+// returns `comp` itself, so the engines can still recognize plain ascending order.
+template <typename Compare, typename Proj>
+auto projectedCompare(Compare comp, Proj proj) {
+    if constexpr (std::is_same<Proj, std::identity>::value) {
+        return comp;
+    } else {
+        return [comp, proj](const auto& a, const auto& b) {
+            return std::invoke(comp, std::invoke(proj, a), std::invoke(proj, b));
+        };
+    }
+}
+
+// The key a range's elements are compared by: proj(element) without cv or reference
+template <typename R, typename Proj>
+using ProjectedKey = std::remove_cvref_t<std::indirect_result_t<Proj&, std::ranges::iterator_t<R>>>;
+
+// +1 for comparators that mean ascending operator< on Key, -1 for descending operator>,
+// 0 for anything else: std::less<>, std::less<Key> and std::ranges::less (and the greater
+// equivalents), as plainOrder does. Without Key only the transparent comparators count.
+// The key-based engines (radix, counting, index) only know these two orders.
+template <typename Compare, typename Key = void>
+constexpr int keyDirection = std::is_same<Compare, std::ranges::less>::value || std::is_same<Compare, std::less<>>::value ||
+                                     std::is_same<Compare, std::less<Key>>::value
+                                 ? 1
+                             : std::is_same<Compare, std::ranges::greater>::value || std::is_same<Compare, std::greater<>>::value ||
+                                     std::is_same<Compare, std::greater<Key>>::value
+                                 ? -1
+                                 : 0;
+
+// Radix key of proj(x), inverted for descending order
+template <typename Proj, bool Descending>
+struct ProjectedRadixKey {
+    Proj proj;
+    template <typename T>
+    auto operator()(const T& x) const {
+        auto key = radixKey(std::invoke(proj, x));
+        return Descending ? static_cast<decltype(key)>(~key) : key;
+    }
+};
+
+template <bool Descending, typename Proj>
+ProjectedRadixKey<Proj, Descending> projectedRadixKey(Proj proj) {
+    return {proj};
+}
+
+// Comparison sorts
+
+// Insertion Sort of a range
+template <typename R, typename Compare = std::ranges::less, typename Proj = std::identity>
+    requires SortableRange<R, Compare, Proj>
+void insertionSort(R&& range, Compare comp = {}, Proj proj = {}) {
+    insertionSort(std::ranges::begin(range), rangeEnd(range), projectedCompare(comp, proj));
+}
+
+// Binary Insertion Sort of a range; stable
+template <typename R, typename Compare = std::ranges::less, typename Proj = std::identity>
+    requires SortableRange<R, Compare, Proj>
+void binaryInsertionSort(R&& range, Compare comp = {}, Proj proj = {}) {
+    binaryInsertionSort(std::ranges::begin(range), rangeEnd(range), projectedCompare(comp, proj));
+}
+
+// Heap Sort of a range
+template <typename R, typename Compare = std::ranges::less, typename Proj = std::identity>
+    requires SortableRange<R, Compare, Proj>
+void heapSort(R&& range, Compare comp = {}, Proj proj = {}) {
+    heapSort(std::ranges::begin(range), rangeEnd(range), projectedCompare(comp, proj));
+}
+
+// Intro Sort of a range
+template <typename R, typename Compare = std::ranges::less, typename Proj = std::identity>
+    requires SortableRange<R, Compare, Proj>
+void introSort(R&& range, Compare comp = {}, Proj proj = {}) {
+    introSort(std::ranges::begin(range), rangeEnd(range), projectedCompare(comp, proj));
+}
+
+// Buffered Merge Sort of a range; stable
+template <typename R, typename Compare = std::ranges::less, typename Proj = std::identity>
+    requires SortableRange<R, Compare, Proj>
+void bufferedMergeSort(R&& range, Compare comp = {}, Proj proj = {}) {
+    bufferedMergeSort(std::ranges::begin(range), rangeEnd(range), projectedCompare(comp, proj));
+}
+
+// Natural Merge Sort of a range; stable
+template <typename R, typename Compare = std::ranges::less, typename Proj = std::identity>
+    requires SortableRange<R, Compare, Proj>
+void naturalMergeSort(R&& range, Compare comp = {}, Proj proj = {}) {
+    naturalMergeSort(std::ranges::begin(range), rangeEnd(range), projectedCompare(comp, proj));
+}
+
+// Parallel Hybrid Quick Sort of a range
+template <typename R, typename Compare = std::ranges::less, typename Proj = std::identity>
+    requires SortableRange<R, Compare, Proj>
+void parallelQuickSort(R&& range, ThreadPool& pool, Compare comp = {}, Proj proj = {}) {
+    parallelQuickSort(std::ranges::begin(range), rangeEnd(range), pool, projectedCompare(comp, proj));
+}
+
+// Parallel Hybrid Merge Sort of a range; stable
+template <typename R, typename Compare = std::ranges::less, typename Proj = std::identity>
+    requires SortableRange<R, Compare, Proj>
+void parallelMergeSort(R&& range, ThreadPool& pool, Compare comp = {}, Proj proj = {}) {
+    std::vector<std::ranges::range_value_t<R>> buffer;
+    parallelMergeSort(std::ranges::begin(range), rangeEnd(range), pool, buffer, projectedCompare(comp, proj));
+}
+
+// Parallel Merge Sort of a range with a k-way final stage; stable
+template <typename R, typename Compare = std::ranges::less, typename Proj = std::identity>
+    requires SortableRange<R, Compare, Proj>
+void parallelKWayMergeSort(R&& range, ThreadPool& pool, Compare comp = {}, Proj proj = {}) {
+    std::vector<std::ranges::range_value_t<R>> buffer;
+    parallelKWayMergeSort(std::ranges::begin(range), rangeEnd(range), pool, buffer, projectedCompare(comp, proj));
+}
+
+// Adaptive sort of a range; the counting, radix and vector engines need the identity
+// projection and plain ascending order
+template <typename R, typename Compare = std::ranges::less, typename Proj = std::identity>
+    requires SortableRange<R, Compare, Proj>
+SortChoice adaptiveSort(R&& range, Compare comp = {}, Proj proj = {}) {
+    return adaptiveSort(std::ranges::begin(range), rangeEnd(range), projectedCompare(comp, proj));
+}
+
+// Key-based sorts: ascending or descending order of an arithmetic key
+
+// LSD Radix Sort of a range by proj(element), which must be a 32/64-bit integer or
+// float/double; stable in both directions
+template <typename R, typename Compare = std::ranges::less, typename Proj = std::identity>
+    requires SortableRange<R, Compare, Proj>
+void lsdRadixSort(R&& range, Compare = {}, Proj proj = {}) {
+    constexpr int direction = keyDirection<Compare, ProjectedKey<R, Proj>>;
+    static_assert(direction != 0, "Radix sorts order keys by std::ranges::less or std::ranges::greater");
+    std::vector<std::ranges::range_value_t<R>> buffer;
+    lsdRadixSort(std::ranges::begin(range), rangeEnd(range), buffer, projectedRadixKey<(direction < 0)>(proj));
+}
+
+// MSD Radix Sort of a range by proj(element); not stable
+template <typename R, typename Compare = std::ranges::less, typename Proj = std::identity>
+    requires SortableRange<R, Compare, Proj>
+void msdRadixSort(R&& range, Compare = {}, Proj proj = {}) {
+    constexpr int direction = keyDirection<Compare, ProjectedKey<R, Proj>>;
+    static_assert(direction != 0, "Radix sorts order keys by std::ranges::less or std::ranges::greater");
+    msdRadixSort(std::ranges::begin(range), rangeEnd(range), projectedRadixKey<(direction < 0)>(proj));
+}
+
+// Integer sort of a range: Counting Sort or a sorting network for integer elements,
+// LSD Radix Sort by the projected key otherwise
+template <typename R, typename Compare = std::ranges::less, typename Proj = std::identity>
+    requires SortableRange<R, Compare, Proj>
+void integerSort(R&& range, Compare comp = {}, Proj proj = {}) {
+    constexpr int direction = keyDirection<Compare, ProjectedKey<R, Proj>>;
+    static_assert(direction != 0, "Integer sorts order keys by std::ranges::less or std::ranges::greater");
+    using T = std::ranges::range_value_t<R>;
+    if constexpr (std::is_same<Proj, std::identity>::value && std::is_integral<T>::value) {
+        auto first = std::ranges::begin(range);
+        auto last = rangeEnd(range);
+        std::vector<T> buffer;
+        integerSort(first, last, buffer);
+        // Equal integers are indistinguishable, so reversing gives the descending order
+        if (direction < 0) std::reverse(first, last);
+    } else {
+        lsdRadixSort(range, comp, proj);
+    }
+}
+
+// Stable sorting permutation of a range by comp after proj: perm[i] is the index of the
+// element that belongs at position i. Plain ascending or descending order uses the
+// radix-sorted keyPrefix of the projected keys; other comparators, and keys without a
+// keyPrefix, fall back to comparisons.
+template <typename R, typename Compare = std::ranges::less, typename Proj = std::identity>
+    requires SortableRange<R, Compare, Proj>
+std::vector<size_t> sortPermutation(R&& range, Compare comp = {}, Proj proj = {}) {
+    using Key = ProjectedKey<R, Proj>;
+    constexpr int direction = keyDirection<Compare, Key>;
+    auto prefix = [&proj](const auto& x) -> uint64_t {
+        if constexpr (direction > 0 && HasKeyPrefix<Key>) return keyPrefix(std::invoke(proj, x));
+        else if constexpr (direction < 0 && HasKeyPrefix<Key>) return ~keyPrefix(std::invoke(proj, x));
+        else return 0;
+    };
+    return sortPermutation(std::ranges::begin(range), rangeEnd(range), prefix, projectedCompare(comp, proj),
+                           direction != 0 && prefixIsExact<Key>);
+}
+
+// Index Sort of a range: sort the permutation, then move every element once; stable
+template <typename R, typename Compare = std::ranges::less, typename Proj = std::identity>
+    requires SortableRange<R, Compare, Proj>
+void indexSort(R&& range, Compare comp = {}, Proj proj = {}) {
+    std::vector<size_t> perm = sortPermutation(range, comp, proj);
+    applyPermutation(std::ranges::begin(range), perm);
+}
+
+// String sorts: ascending order of the string proj(element)
+
+// Multikey Quick Sort of a range
+template <typename R, typename Compare = std::ranges::less, typename Proj = std::identity>
+    requires SortableRange<R, Compare, Proj>
+void multikeyQuickSort(R&& range, Compare = {}, Proj proj = {}) {
+    static_assert(keyDirection<Compare, ProjectedKey<R, Proj>> > 0, "String sorts order strings by std::ranges::less");
+    multikeyQuickSort(std::ranges::begin(range), rangeEnd(range), 0, proj);
+}
+
+// Cached-prefix MSD Radix Sort of a range
+template <typename R, typename Compare = std::ranges::less, typename Proj = std::identity>
+    requires SortableRange<R, Compare, Proj>
+void cachedPrefixRadixSort(R&& range, Compare = {}, Proj proj = {}) {
+    static_assert(keyDirection<Compare, ProjectedKey<R, Proj>> > 0, "String sorts order strings by std::ranges::less");
+    cachedPrefixRadixSort(std::ranges::begin(range), rangeEnd(range), proj);
+}
+
+// LCP Merge Sort of a range; stable
+template <typename R, typename Compare = std::ranges::less, typename Proj = std::identity>
+    requires SortableRange<R, Compare, Proj>
+void lcpMergeSort(R&& range, Compare = {}, Proj proj = {}) {
+    static_assert(keyDirection<Compare, ProjectedKey<R, Proj>> > 0, "String sorts order strings by std::ranges::less");
+    lcpMergeSort(std::ranges::begin(range), rangeEnd(range), proj);
+}
+
+// Parallel String Sample Sort of a range
+template <typename R, typename Compare = std::ranges::less, typename Proj = std::identity>
+    requires SortableRange<R, Compare, Proj>
+void parallelStringSampleSort(R&& range, ThreadPool& pool, Compare = {}, Proj proj = {}) {
+    static_assert(keyDirection<Compare, ProjectedKey<R, Proj>> > 0, "String sorts order strings by std::ranges::less");
+    parallelStringSampleSort(std::ranges::begin(range), rangeEnd(range), pool, proj);
+}
+
+// Selection: ranks of a random-access range in place
+
+// Put the element of rank k of a range where a sort by comp after proj would put it
+template <typename R, typename Compare = std::ranges::less, typename Proj = std::identity>
+    requires SortableRange<R, Compare, Proj>
+void nthElement(R&& range, size_t k, Compare comp = {}, Proj proj = {}) {
+    auto first = std::ranges::begin(range);
+    nthElement(first, first + k, rangeEnd(range), projectedCompare(comp, proj));
+}
+
+// Sort the k first elements of a range by comp after proj; the rest are left in any order
+template <typename R, typename Compare = std::ranges::less, typename Proj = std::identity>
+    requires SortableRange<R, Compare, Proj>
+void partialSort(R&& range, size_t k, Compare comp = {}, Proj proj = {}) {
+    auto first = std::ranges::begin(range);
+    auto last = rangeEnd(range);
+    partialSort(first, first + std::min<size_t>(k, last - first), last, projectedCompare(comp, proj));
+}
+
+// Put the elements of every rank in `ranks` where a sort by comp after proj would put them
+template <typename R, typename Compare = std::ranges::less, typename Proj = std::identity>
+    requires SortableRange<R, Compare, Proj>
+void multiSelect(R&& range, std::vector<long> ranks, Compare comp = {}, Proj proj = {}) {
+    multiSelect(std::ranges::begin(range), rangeEnd(range), std::move(ranks), projectedCompare(comp, proj));
+}
+
+// Selection: the best k elements of any input range in one pass and O(k) memory
+
+// The k largest elements of a range by comp after proj, best first
+template <std::ranges::input_range R, typename Compare = std::ranges::less, typename Proj = std::identity>
+std::vector<std::ranges::range_value_t<R>> topK(R&& range, size_t k, Compare comp = {}, Proj proj = {}) {
+    auto order = projectedCompare(comp, proj);
+    TopK<std::ranges::range_value_t<R>, decltype(order)> selector(k, order);
+    selector.pushBatch(range);
+    return selector.sorted();
+}
+
+// The k smallest elements of a range by comp after proj, smallest first
+template <std::ranges::input_range R, typename Compare = std::ranges::less, typename Proj = std::identity>
+std::vector<std::ranges::range_value_t<R>> bottomK(R&& range, size_t k, Compare comp = {}, Proj proj = {}) {
+    return topK(std::forward<R>(range), k, ReverseCompare<Compare>{comp}, proj);
+}
@@ -0,0 +1,271 @@
+#pragma once
+
+#include <algorithm>
+#include <cmath>
+#include <functional>
+#include <iterator>
+#include <utility>
+#include <vector>
+#include "Lab4_Heap.h"
+#include "Lab4_IntroSort.h"
+#include "Lab4_Partition.h"
+#include "Lab4_SortingNetwork.h"
+
+// Selection: put the element of rank k where a full sort would, with smaller-or-equal keys
+// before it and greater-or-equal keys after it, in O(n) expected time (nth_element).
+
+// Ranges at or below this size are finished with smallSort
+const int selectThreshold = 16;
+
+// Ranges above this size take their pivot from a Floyd-Rivest sample
+const long floydRivestCutoff = 600;
+
+// Heap selection, the worst-case fallback: keep the nth - first + 1 smallest keys in a
+// max-heap while scanning the rest, then move the heap's top to nth. O(n log k); the
+// smaller side of nth is the one kept in the heap.
+template <typename It, typename Compare = std::less<>>
+void heapSelect(It first, It nth, It last, Compare comp = {}) {
+    if (nth == last) return;
+    if (nth - first > last - nth) {
+        // Mirror image: the keys from nth on are the largest, kept in a min-heap
+        ReverseCompare<Compare> reverse{comp};
+        long n = last - nth;
+        It heap = nth;
+        buildMaxHeap(heap, last, reverse);
+        for (It it = first; it != nth; ++it) {
+            if (comp(*it, *heap)) continue;
+            std::iter_swap(it, heap);
+            siftDown<2>(heap, n, 0, reverse);
+        }
+        return;
+    }
+    long n = nth - first + 1;
+    buildMaxHeap(first, nth + 1, comp);
+    for (It it = nth + 1; it != last; ++it) {
+        if (!comp(*it, *first)) continue;
+        std::iter_swap(it, first);
+        siftDown<2>(first, n, 0, comp);
+    }
+    std::iter_swap(first, nth);
+}
+
+// Partition [first, last) around *pivot with the engine of `scheme`. Returns the block
+// [lt, gt) of keys already in their final place: the pivot alone, or every key equal to it
+// with ThreeWay.
+// Keys before first and from last on are already partitioned against the range; begin and
+// end bound where such neighbours exist. A pivot no greater than first[-1] is the range's
+// minimum, and a two-way partition around it would only split off the pivot itself, so the
+// keys equal to it are gathered instead (as pattern-defeating quicksort does), and likewise
+// for a pivot no smaller than *last. Runs of duplicates then cost one pass, not one per key.
+template <typename It, typename Compare>
+std::pair<It, It> selectPartition(It begin, It first, It last, It end, It pivot, PartitionScheme scheme,
+                                  Compare comp) {
+    if (first != begin && !comp(first[-1], *pivot)) {
+        It before = first - 1;
+        return {first, std::partition(first, last, [&](const auto& x) { return !comp(*before, x); })};
+    }
+    if (last != end && !comp(*pivot, *last)) {
+        It after = last;
+        return {std::partition(first, last, [&](const auto& x) { return comp(x, *after); }), last};
+    }
+    std::iter_swap(pivot, last - 1);
+    if (scheme == PartitionScheme::ThreeWay) return threeWayPartition(first, last, comp);
+    It p = twoWayPartition(first, last, scheme, comp);
+    return {p, p + 1};
+}
+
+// Quickselect that only descends into the side holding nth, with heapSelect after
+// 2*log2(n) partitions that failed to shrink the range
+template <typename It, typename Compare>
+void introSelectLoop(It first, It nth, It last, int depthLimit, PartitionScheme scheme, Compare comp) {
+    It begin = first, end = last;
+    while (last - first > selectThreshold) {
+        if (depthLimit == 0) {
+            heapSelect(first, nth, last, comp);
+            return;
+        }
+        --depthLimit;
+        auto [lt, gt] = selectPartition(begin, first, last, end, choosePivot(first, last, comp), scheme, comp);
+        if (nth < lt) {
+            last = lt;
+        } else if (nth >= gt) {
+            first = gt;
+        } else {
+            return;
+        }
+    }
+    smallSort(first, last, comp);
+}
+
+// Introselect of nth in [first, last) by `comp`: median-of-three/ninther pivots,
+// O(n) expected and O(n log n) in the worst case
+template <typename It, typename Compare = std::less<>>
+    requires std::random_access_iterator<It>
+void introSelect(It first, It nth, It last, Compare comp = {},
+                 PartitionScheme scheme = PartitionScheme::Lomuto) {
+    if (last - first < 2 || nth == last) return;
+    introSelectLoop(first, nth, last, 2 * floorLog2(last - first), scheme, comp);
+}
+
+// Floyd-Rivest selection: the pivot is the key of nth's expected rank within a sample of
+// about n^(2/3) keys around nth, itself found recursively. The pivot then lands within a
+// few sample gaps of nth, so one partition of the whole range leaves about n^(2/3) keys
+// to select among: n + min(k, n - k) + o(n) comparisons instead of quickselect's ~3.4n.
+template <typename It, typename Compare>
+void floydRivestLoop(It first, It nth, It last, int depthLimit, PartitionScheme scheme, Compare comp) {
+    It begin = first, end = last;
+    while (last - first > selectThreshold) {
+        if (depthLimit == 0) {
+            heapSelect(first, nth, last, comp);
+            return;
+        }
+        --depthLimit;
+        long n = last - first;
+        It pivot;
+        if (n > floydRivestCutoff) {
+            // Sample [first + left, first + right) around nth, skewed away from the middle
+            long i = nth - first;
+            double z = std::log(static_cast<double>(n));
+            double s = 0.5 * std::exp(2.0 * z / 3.0);
+            double sd = 0.5 * std::sqrt(z * s * (n - s) / n) * (i < n / 2 ? -1.0 : 1.0);
+            long left = std::max(0L, static_cast<long>(i - i * s / n + sd));
+            long right = std::min(n, static_cast<long>(i + (n - i) * s / n + sd) + 1);
+            floydRivestLoop(first + std::min(left, i), nth, first + std::max(right, i + 1), depthLimit, scheme, comp);
+            pivot = nth;
+        } else {
+            pivot = choosePivot(first, last, comp);
+        }
+        auto [lt, gt] = selectPartition(begin, first, last, end, pivot, scheme, comp);
+        if (nth < lt) {
+            last = lt;
+        } else if (nth >= gt) {
+            first = gt;
+        } else {
+            return;
+        }
+    }
+    smallSort(first, last, comp);
+}
+
+// Floyd-Rivest selection of nth in [first, last) by `comp`, with the same heapSelect
+// worst-case protection as introSelect
+template <typename It, typename Compare = std::less<>>
+    requires std::random_access_iterator<It>
+void floydRivestSelect(It first, It nth, It last, Compare comp = {},
+                       PartitionScheme scheme = PartitionScheme::Lomuto) {
+    if (last - first < 2 || nth == last) return;
+    floydRivestLoop(first, nth, last, 2 * floorLog2(last - first), scheme, comp);
+}
+
+// nth_element: Floyd-Rivest above floydRivestCutoff keys, where its sample pays off,
+// introselect below. Selection is nothing but partitions, so it defaults to the vector
+// engine (Block for keys it cannot vectorize).
+template <typename It, typename Compare = std::less<>>
+    requires std::random_access_iterator<It>
+void nthElement(It first, It nth, It last, Compare comp = {}, PartitionScheme scheme = PartitionScheme::Simd) {
+    if (last - first > floydRivestCutoff) {
+        floydRivestSelect(first, nth, last, comp, scheme);
+    } else {
+        introSelect(first, nth, last, comp, scheme);
+    }
+}
+
+// nthElement of arr with rank k; returns the selected key
+template <typename T>
+const T& nthElement(std::vector<T>& arr, int k) {
+    nthElement(arr.begin(), arr.begin() + k, arr.end());
+    return arr[k];
+}
+
+// Put the middle - first smallest keys of [first, last) in sorted order in [first, middle):
+// select the last of them, then sort only the prefix. O(n + k log k), against the
+// O(n log k) of a heap-based partial sort.
+template <typename It, typename Compare = std::less<>>
+    requires std::random_access_iterator<It>
+void partialSort(It first, It middle, It last, Compare comp = {}) {
+    if (middle == first) return;
+    nthElement(first, middle - 1, last, comp);
+    introSort(first, middle - 1, comp);
+}
+
+// Sort the k smallest keys of arr into arr[0..k-1]
+template <typename T>
+void partialSort(std::vector<T>& arr, int k) {
+    partialSort(arr.begin(), arr.begin() + std::min<size_t>(k, arr.size()), arr.end());
+}
+
+// Select every rank in [rankFirst, rankLast) (sorted offsets from base) within [first, last):
+// one partition serves every rank, and each side recurses with only the ranks that fall in it
+template <typename It, typename Compare>
+void multiSelectLoop(It base, It first, It last, It end, const long* rankFirst, const long* rankLast,
+                     int depthLimit, PartitionScheme scheme, Compare comp) {
+    while (rankFirst != rankLast) {
+        if (rankLast - rankFirst == 1) {
+            nthElement(first, base + *rankFirst, last, comp, scheme);
+            return;
+        }
+        if (last - first <= selectThreshold) {
+            smallSort(first, last, comp);
+            return;
+        }
+        if (depthLimit == 0) {
+            // Bad pivots with several ranks left: sorting the range settles all of them
+            heapSort(first, last, comp);
+            return;
+        }
+        --depthLimit;
+        auto [lt, gt] = selectPartition(base, first, last, end, choosePivot(first, last, comp), scheme, comp);
+        // Ranks below lt go left, ranks from gt on go right, ranks in between are done
+        const long* leftEnd = std::lower_bound(rankFirst, rankLast, lt - base);
+        const long* rightBegin = std::lower_bound(leftEnd, rankLast, gt - base);
+        // Recurse on the side with fewer keys and loop on the other
+        if (lt - first < last - gt) {
+            multiSelectLoop(base, first, lt, end, rankFirst, leftEnd, depthLimit, scheme, comp);
+            first = gt;
+            rankFirst = rightBegin;
+        } else {
+            multiSelectLoop(base, gt, last, end, rightBegin, rankLast, depthLimit, scheme, comp);
+            last = lt;
+            rankLast = leftEnd;
+        }
+    }
+}
+
+// Multi-select: every rank in `ranks` (offsets into [first, last), any order, duplicates
+// allowed) ends up holding the key a full sort would put there, in one pass of O(n log r)
+// for r ranks instead of r separate selections
+template <typename It, typename Compare = std::less<>>
+    requires std::random_access_iterator<It>
+void multiSelect(It first, It last, std::vector<long> ranks, Compare comp = {},
+                 PartitionScheme scheme = PartitionScheme::Simd) {
+    std::sort(ranks.begin(), ranks.end());
+    ranks.erase(std::unique(ranks.begin(), ranks.end()), ranks.end());
+    if (ranks.empty() || last - first < 2) return;
+    multiSelectLoop(first, first, last, last, ranks.data(), ranks.data() + ranks.size(),
+                    2 * floorLog2(last - first), scheme, comp);
+}
+
+// Percentiles p in [0, 1] of [first, last) with the linear interpolation of percentile() in
+// Lab4_Benchmark.h, through one multi-select instead of a sort; reorders the range
+template <typename It>
+    requires std::random_access_iterator<It>
+std::vector<double> percentiles(It first, It last, const std::vector<double>& ps) {
+    long n = last - first;
+    std::vector<double> values(ps.size(), 0.0);
+    if (n == 0) return values;
+    std::vector<long> ranks;
+    for (double p : ps) {
+        long lower = static_cast<long>(p * (n - 1));
+        ranks.push_back(lower);
+        ranks.push_back(std::min(lower + 1, n - 1));
+    }
+    multiSelect(first, last, ranks);
+    for (size_t i = 0; i < ps.size(); ++i) {
+        double rank = ps[i] * (n - 1);
+        long lower = static_cast<long>(rank);
+        long upper = std::min(lower + 1, n - 1);
+        double low = static_cast<double>(first[lower]);
+        values[i] = low + (static_cast<double>(first[upper]) - low) * (rank - lower);
+    }
+    return values;
+}
@@ -0,0 +1,182 @@
+#pragma once
+
+#include <cstdint>
+#include <functional>
+#include <utility>
+#include "Lab4_SortingNetwork.h"
+
+// Branchless Lomuto partition of [first, last): keys not greater than pivot come first.
+// Every key is swapped unconditionally and the boundary advances by the comparison
+// result, so the loop has no data-dependent branch. Returns the number of keys <= pivot.
+template <typename It, typename T, typename Compare = std::less<>>
+long branchlessPartition(It first, It last, const T& pivot, Compare comp = {}) {
+    It boundary = first;
+    for (It it = first; it < last; ++it) {
+        auto key = std::move(*it);
+        bool left = !comp(pivot, key);
+        *it = std::move(*boundary);
+        *boundary = std::move(key);
+        boundary += left;
+    }
+    return boundary - first;
+}
+
+// Key types with a vectorized partition
+template <typename T>
+constexpr bool hasSimdPartition = hasNetworkSort<T>;
+
+#if (defined(__x86_64__) || defined(__i386__)) && defined(__GNUC__)
+#include <immintrin.h>
+
+// Left-pack permutations for AVX2: entry `mask` lists the lanes whose bit is set,
+// then the others, as indices of 32-bit elements (a 64-bit lane is two of them)
+template <int Lanes>
+struct PackTable {
+    uint8_t index[1 << Lanes][8];
+};
+
+template <int Lanes>
+constexpr PackTable<Lanes> makePackTable() {
+    PackTable<Lanes> table{};
+    const int width = 8 / Lanes;
+    for (int mask = 0; mask < (1 << Lanes); ++mask) {
+        int out = 0;
+        for (int pass = 0; pass < 2; ++pass) {
+            for (int lane = 0; lane < Lanes; ++lane) {
+                if (((mask >> lane) & 1) != (pass == 0 ? 1 : 0)) continue;
+                for (int half = 0; half < width; ++half) {
+                    table.index[mask][out++] = static_cast<uint8_t>(lane * width + half);
+                }
+            }
+        }
+    }
+    return table;
+}
+
+inline constexpr PackTable<8> packTable8 = makePackTable<8>();
+inline constexpr PackTable<4> packTable4 = makePackTable<4>();
+
+#pragma GCC push_options
+#pragma GCC target("avx2,popcnt")
+namespace avx2 {
+
+// Permutation index vector for a left-pack table entry
+inline __m256i packIndex(const uint8_t* entry) {
+    return _mm256_cvtepu8_epi32(_mm_loadl_epi64(reinterpret_cast<const __m128i*>(entry)));
+}
+
+template <typename T> struct PartitionOps;
+
+template <> struct PartitionOps<int32_t> {
+    using Vec = __m256i;
+    static const int lanes = 8;
+    static Vec broadcast(int32_t x) { return _mm256_set1_epi32(x); }
+    static Vec load(const int32_t* p) { return _mm256_loadu_si256(reinterpret_cast<const __m256i*>(p)); }
+    static void store(int32_t* p, Vec v) { _mm256_storeu_si256(reinterpret_cast<__m256i*>(p), v); }
+    static unsigned leftMask(Vec v, Vec pivot) {
+        return ~_mm256_movemask_ps(_mm256_castsi256_ps(_mm256_cmpgt_epi32(v, pivot))) & 0xFF;
+    }
+    static Vec pack(Vec v, unsigned mask, int) { return _mm256_permutevar8x32_epi32(v, packIndex(packTable8.index[mask])); }
+};
+
+template <> struct PartitionOps<float> {
+    using Vec = __m256;
+    static const int lanes = 8;
+    static Vec broadcast(float x) { return _mm256_set1_ps(x); }
+    static Vec load(const float* p) { return _mm256_loadu_ps(p); }
+    static void store(float* p, Vec v) { _mm256_storeu_ps(p, v); }
+    static unsigned leftMask(Vec v, Vec pivot) { return _mm256_movemask_ps(_mm256_cmp_ps(v, pivot, _CMP_LE_OQ)); }
+    static Vec pack(Vec v, unsigned mask, int) { return _mm256_permutevar8x32_ps(v, packIndex(packTable8.index[mask])); }
+};
+
+template <> struct PartitionOps<double> {
+    using Vec = __m256d;
+    static const int lanes = 4;
+    static Vec broadcast(double x) { return _mm256_set1_pd(x); }
+    static Vec load(const double* p) { return _mm256_loadu_pd(p); }
+    static void store(double* p, Vec v) { _mm256_storeu_pd(p, v); }
+    static unsigned leftMask(Vec v, Vec pivot) { return _mm256_movemask_pd(_mm256_cmp_pd(v, pivot, _CMP_LE_OQ)); }
+    static Vec pack(Vec v, unsigned mask, int) {
+        return _mm256_castps_pd(_mm256_permutevar8x32_ps(_mm256_castpd_ps(v), packIndex(packTable4.index[mask])));
+    }
+};
+
+#include "Lab4_SimdPartitionKernels.inc"
+
+} // namespace avx2
+#pragma GCC pop_options
+
+#pragma GCC push_options
+#pragma GCC target("avx512f,popcnt")
+namespace avx512 {
+
+// AVX-512 packs with compress: the selected lanes are compressed to the front and
+// the others expanded into the lanes behind them
+template <typename T> struct PartitionOps;
+
+template <> struct PartitionOps<int32_t> {
+    using Vec = __m512i;
+    static const int lanes = 16;
+    static Vec broadcast(int32_t x) { return _mm512_set1_epi32(x); }
+    static Vec load(const int32_t* p) { return _mm512_loadu_si512(p); }
+    static void store(int32_t* p, Vec v) { _mm512_storeu_si512(p, v); }
+    static unsigned leftMask(Vec v, Vec pivot) { return _mm512_cmple_epi32_mask(v, pivot); }
+    static Vec pack(Vec v, unsigned mask, int count) {
+        __mmask16 rights = static_cast<__mmask16>(~mask);
+        __mmask16 tail = static_cast<__mmask16>(0xFFFFu << count);
+        return _mm512_mask_expand_epi32(_mm512_maskz_compress_epi32(static_cast<__mmask16>(mask), v), tail,
+                                        _mm512_maskz_compress_epi32(rights, v));
+    }
+};
+
+template <> struct PartitionOps<float> {
+    using Vec = __m512;
+    static const int lanes = 16;
+    static Vec broadcast(float x) { return _mm512_set1_ps(x); }
+    static Vec load(const float* p) { return _mm512_loadu_ps(p); }
+    static void store(float* p, Vec v) { _mm512_storeu_ps(p, v); }
+    static unsigned leftMask(Vec v, Vec pivot) { return _mm512_cmp_ps_mask(v, pivot, _CMP_LE_OQ); }
+    static Vec pack(Vec v, unsigned mask, int count) {
+        __mmask16 rights = static_cast<__mmask16>(~mask);
+        __mmask16 tail = static_cast<__mmask16>(0xFFFFu << count);
+        return _mm512_mask_expand_ps(_mm512_maskz_compress_ps(static_cast<__mmask16>(mask), v), tail,
+                                     _mm512_maskz_compress_ps(rights, v));
+    }
+};
+
+template <> struct PartitionOps<double> {
+    using Vec = __m512d;
+    static const int lanes = 8;
+    static Vec broadcast(double x) { return _mm512_set1_pd(x); }
+    static Vec load(const double* p) { return _mm512_loadu_pd(p); }
+    static void store(double* p, Vec v) { _mm512_storeu_pd(p, v); }
+    static unsigned leftMask(Vec v, Vec pivot) { return _mm512_cmp_pd_mask(v, pivot, _CMP_LE_OQ); }
+    static Vec pack(Vec v, unsigned mask, int count) {
+        __mmask8 rights = static_cast<__mmask8>(~mask);
+        __mmask8 tail = static_cast<__mmask8>(0xFFu << count);
+        return _mm512_mask_expand_pd(_mm512_maskz_compress_pd(static_cast<__mmask8>(mask), v), tail,
+                                     _mm512_maskz_compress_pd(rights, v));
+    }
+};
+
+#include "Lab4_SimdPartitionKernels.inc"
+
+} // namespace avx512
+#pragma GCC pop_options
+#endif
+
+// Partition [first, last) around `pivot` with the widest vector partition this CPU has:
+// keys <= pivot come first. Falls back to branchlessPartition without AVX2.
+// Returns the number of keys <= pivot. NaNs are not supported.
+template <typename T>
+long simdPartitionKeys(T* first, T* last, T pivot) {
+    static_assert(hasSimdPartition<T>, "Vector partitions exist for int32_t, float and double");
+#if (defined(__x86_64__) || defined(__i386__)) && defined(__GNUC__)
+    switch (simdLevel()) {
+        case SimdLevel::Avx512: return avx512::partitionKeys(first, last, pivot);
+        case SimdLevel::Avx2: return avx2::partitionKeys(first, last, pivot);
+        default: break;
+    }
+#endif
+    return branchlessPartition(first, last, pivot);
+}
@@ -0,0 +1,215 @@
+#pragma once
+
+#include <algorithm>
+#include <bit>
+#include <cstddef>
+#include <functional>
+#include <limits>
+#include <memory>
+#include <span>
+#include <utility>
+#include <vector>
+#include "Lab4_AdaptiveSort.h"
+#include "Lab4_Heap.h"
+
+// Queue and stack adapters that expose their storage as one contiguous span, so their
+// contents can be sorted in place by any engine (e.g. introSort(queue.contents()) through
+// Lab4_Ranges.h) and then drained, instead of being popped into a vector, sorted there and
+// pushed back. Elements are only ever moved.
+
+// Hand the smallest elements of [first, last) by `comp` to `sink` in order, at most `limit`
+// of them: the range becomes a heap in place (O(n)), then every element taken costs one
+// bottom-up sift, so draining k of n costs O(n + k log n) instead of a full sort.
+// The elements taken are moved out of the back of the range; the rest stay in heap order.
+// Returns how many were taken.
+template <typename It, typename Sink, typename Compare = std::less<>>
+size_t priorityDrain(It first, It last, Sink& sink, Compare comp = {},
+                     size_t limit = std::numeric_limits<size_t>::max()) {
+    ReverseCompare<Compare> order{comp};
+    buildMaxHeap(first, last, order);
+    size_t taken = 0;
+    for (long n = last - first; n > 0 && taken < limit; --n, ++taken) {
+        std::swap(first[0], first[n - 1]);
+        siftDownBottomUp(first, n - 1, 0, order);
+        sink(std::move(first[n - 1]));
+    }
+    return taken;
+}
+
+// FIFO queue over a power-of-two ring buffer
+template <typename T>
+class SortableQueue {
+public:
+    SortableQueue() = default;
+
+    SortableQueue(const SortableQueue& other) {
+        reserve(other.count);
+        for (size_t i = 0; i < other.count; ++i) push(other.at(i));
+    }
+
+    SortableQueue(SortableQueue&& other) noexcept { swap(other); }
+
+    SortableQueue& operator=(SortableQueue other) noexcept {
+        swap(other);
+        return *this;
+    }
+
+    ~SortableQueue() {
+        clear();
+        std::allocator<T>().deallocate(data, capacity);
+    }
+
+    void swap(SortableQueue& other) noexcept {
+        std::swap(data, other.data);
+        std::swap(capacity, other.capacity);
+        std::swap(head, other.head);
+        std::swap(count, other.count);
+    }
+
+    size_t size() const { return count; }
+    bool empty() const { return count == 0; }
+
+    T& front() { return at(0); }
+    const T& front() const { return at(0); }
+    T& back() { return at(count - 1); }
+    const T& back() const { return at(count - 1); }
+
+    void reserve(size_t n) {
+        if (n > capacity) reallocate(std::bit_ceil(n));
+    }
+
+    template <typename... Args>
+    T& emplace(Args&&... args) {
+        if (count == capacity) reallocate(capacity == 0 ? 16 : 2 * capacity);
+        T* slot = std::construct_at(&at(count), std::forward<Args>(args)...);
+        ++count;
+        return *slot;
+    }
+
+    void push(const T& value) { emplace(value); }
+    void push(T&& value) { emplace(std::move(value)); }
+
+    void pop() {
+        std::destroy_at(&at(0));
+        head = (head + 1) & (capacity - 1);
+        --count;
+    }
+
+    void clear() {
+        for (size_t i = 0; i < count; ++i) std::destroy_at(&at(i));
+        head = 0;
+        count = 0;
+    }
+
+    // The elements from front to back as one span. If the ring has wrapped around, the
+    // elements are first moved into a fresh buffer of the same capacity, starting at slot 0.
+    std::span<T> contents() {
+        if (head + count > capacity) reallocate(capacity);
+        return std::span<T>(data + head, count);
+    }
+
+    // Sort the contents so that the queue drains in `comp` order
+    template <typename Compare = std::less<>>
+    void sort(Compare comp = {}) {
+        auto elements = contents();
+        adaptiveSort(elements.begin(), elements.end(), comp);
+    }
+
+    // Pop every element, front first, handing each to `sink` by rvalue
+    template <typename Sink>
+    void drain(Sink sink) {
+        for (size_t i = 0; i < count; ++i) sink(std::move(at(i)));
+        clear();
+    }
+
+    // Pop up to `limit` elements in `comp` order regardless of their place in the queue;
+    // the elements left behind keep no particular order
+    template <typename Sink, typename Compare = std::less<>>
+    size_t drainSorted(Sink sink, Compare comp = {}, size_t limit = std::numeric_limits<size_t>::max()) {
+        auto elements = contents();
+        size_t taken = priorityDrain(elements.begin(), elements.end(), sink, comp, limit);
+        for (size_t i = count - taken; i < count; ++i) std::destroy_at(&at(i));
+        count -= taken;
+        return taken;
+    }
+
+private:
+    T& at(size_t i) { return data[(head + i) & (capacity - 1)]; }
+    const T& at(size_t i) const { return data[(head + i) & (capacity - 1)]; }
+
+    // Move the elements, front first, into a new buffer of `size` slots
+    void reallocate(size_t size) {
+        T* fresh = std::allocator<T>().allocate(size);
+        for (size_t i = 0; i < count; ++i) {
+            std::construct_at(fresh + i, std::move(at(i)));
+            std::destroy_at(&at(i));
+        }
+        std::allocator<T>().deallocate(data, capacity);
+        data = fresh;
+        capacity = size;
+        head = 0;
+    }
+
+    T* data = nullptr;
+    size_t capacity = 0;  // zero or a power of two, so a slot index is a mask away
+    size_t head = 0;      // slot of the front element
+    size_t count = 0;
+};
+
+// LIFO stack over a vector; contents() runs from the bottom to the top
+template <typename T>
+class SortableStack {
+public:
+    size_t size() const { return elements.size(); }
+    bool empty() const { return elements.empty(); }
+
+    T& top() { return elements.back(); }
+    const T& top() const { return elements.back(); }
+
+    void reserve(size_t n) { elements.reserve(n); }
+
+    template <typename... Args>
+    T& emplace(Args&&... args) {
+        return elements.emplace_back(std::forward<Args>(args)...);
+    }
+
+    void push(const T& value) { elements.push_back(value); }
+    void push(T&& value) { elements.push_back(std::move(value)); }
+    void pop() { elements.pop_back(); }
+    void clear() { elements.clear(); }
+
+    std::span<T> contents() { return std::span<T>(elements); }
+
+    // Sort the contents so that the stack drains in `comp` order: the top comes first, so the
+    // storage ends up in reverse `comp` order. A plain descending order is sorted ascending
+    // directly, so it gets the counting, radix and vector engines adaptiveSort keeps for
+    // plain ascending keys; any other order is sorted forwards and reversed.
+    template <typename Compare = std::less<>>
+    void sort(Compare comp = {}) {
+        if constexpr (plainReverseOrder<Compare, T>) {
+            adaptiveSort(elements.begin(), elements.end(), std::less<>());
+        } else {
+            adaptiveSort(elements.begin(), elements.end(), comp);
+            std::reverse(elements.begin(), elements.end());
+        }
+    }
+
+    // Pop every element, top first, handing each to `sink` by rvalue
+    template <typename Sink>
+    void drain(Sink sink) {
+        for (auto it = elements.rbegin(); it != elements.rend(); ++it) sink(std::move(*it));
+        elements.clear();
+    }
+
+    // Pop up to `limit` elements in `comp` order regardless of their place in the stack;
+    // the elements left behind keep no particular order
+    template <typename Sink, typename Compare = std::less<>>
+    size_t drainSorted(Sink sink, Compare comp = {}, size_t limit = std::numeric_limits<size_t>::max()) {
+        size_t taken = priorityDrain(elements.begin(), elements.end(), sink, comp, limit);
+        elements.erase(elements.end() - taken, elements.end());
+        return taken;
+    }
+
+private:
+    std::vector<T> elements;
+};
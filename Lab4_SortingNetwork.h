@@ -0,0 +1,257 @@
+#pragma once
+
+#include <cstdint>
+#include <functional>
+#include <iterator>
+#include <limits>
+#include <type_traits>
+#include <utility>
+#include <vector>
+#include "Lab4_InsertionSort.h"
+
+// Largest block the SIMD sorting networks handle: 64 keys, i.e. 8 AVX2 registers of int32/float
+const int networkMaxElements = 64;
+
+// Vector instruction sets the sorting networks can use, best first
+enum class SimdLevel { Avx512, Avx2, Sse4, Scalar };
+
+#if (defined(__x86_64__) || defined(__i386__)) && defined(__GNUC__)
+#include <immintrin.h>
+
+#pragma GCC push_options
+#pragma GCC target("avx2")
+namespace avx2 {
+
+template <typename T> struct Ops;
+
+template <> struct Ops<int32_t> {
+    using Vec = __m256i;
+    static const int lanes = 8;
+    static Vec broadcast(int32_t x) { return _mm256_set1_epi32(x); }
+    static Vec load(const int32_t* p) { return _mm256_loadu_si256(reinterpret_cast<const __m256i*>(p)); }
+    static void store(int32_t* p, Vec v) { _mm256_storeu_si256(reinterpret_cast<__m256i*>(p), v); }
+    static Vec min(Vec a, Vec b) { return _mm256_min_epi32(a, b); }
+    static Vec max(Vec a, Vec b) { return _mm256_max_epi32(a, b); }
+    static Vec permute(Vec v, const int* perm) {
+        return _mm256_permutevar8x32_epi32(v, _mm256_setr_epi32(perm[0], perm[1], perm[2], perm[3],
+                                                                  perm[4], perm[5], perm[6], perm[7]));
+    }
+    static Vec blend(Vec a, Vec b, const int* takeB) {
+        return _mm256_blendv_epi8(a, b, _mm256_setr_epi32(takeB[0], takeB[1], takeB[2], takeB[3],
+                                                           takeB[4], takeB[5], takeB[6], takeB[7]));
+    }
+    static Vec reverse(Vec v) { return _mm256_permutevar8x32_epi32(v, _mm256_setr_epi32(7, 6, 5, 4, 3, 2, 1, 0)); }
+};
+
+template <> struct Ops<float> {
+    using Vec = __m256;
+    static const int lanes = 8;
+    static Vec broadcast(float x) { return _mm256_set1_ps(x); }
+    static Vec load(const float* p) { return _mm256_loadu_ps(p); }
+    static void store(float* p, Vec v) { _mm256_storeu_ps(p, v); }
+    static Vec min(Vec a, Vec b) { return _mm256_min_ps(a, b); }
+    static Vec max(Vec a, Vec b) { return _mm256_max_ps(a, b); }
+    static Vec permute(Vec v, const int* perm) {
+        return _mm256_permutevar8x32_ps(v, _mm256_setr_epi32(perm[0], perm[1], perm[2], perm[3],
+                                                               perm[4], perm[5], perm[6], perm[7]));
+    }
+    static Vec blend(Vec a, Vec b, const int* takeB) {
+        return _mm256_blendv_ps(a, b, _mm256_castsi256_ps(_mm256_setr_epi32(takeB[0], takeB[1], takeB[2], takeB[3],
+                                                                             takeB[4], takeB[5], takeB[6], takeB[7])));
+    }
+    static Vec reverse(Vec v) { return _mm256_permutevar8x32_ps(v, _mm256_setr_epi32(7, 6, 5, 4, 3, 2, 1, 0)); }
+};
+
+template <> struct Ops<double> {
+    using Vec = __m256d;
+    static const int lanes = 4;
+    static Vec broadcast(double x) { return _mm256_set1_pd(x); }
+    static Vec load(const double* p) { return _mm256_loadu_pd(p); }
+    static void store(double* p, Vec v) { _mm256_storeu_pd(p, v); }
+    static Vec min(Vec a, Vec b) { return _mm256_min_pd(a, b); }
+    static Vec max(Vec a, Vec b) { return _mm256_max_pd(a, b); }
+    // Doubles are moved as pairs of 32-bit halves
+    static Vec permute(Vec v, const int* perm) {
+        __m256i index = _mm256_setr_epi32(2 * perm[0], 2 * perm[0] + 1, 2 * perm[1], 2 * perm[1] + 1,
+                                          2 * perm[2], 2 * perm[2] + 1, 2 * perm[3], 2 * perm[3] + 1);
+        return _mm256_castps_pd(_mm256_permutevar8x32_ps(_mm256_castpd_ps(v), index));
+    }
+    static Vec blend(Vec a, Vec b, const int* takeB) {
+        __m256i mask = _mm256_setr_epi32(takeB[0], takeB[0], takeB[1], takeB[1], takeB[2], takeB[2], takeB[3], takeB[3]);
+        return _mm256_blendv_pd(a, b, _mm256_castsi256_pd(mask));
+    }
+    static Vec reverse(Vec v) { return _mm256_permute4x64_pd(v, 0x1B); }
+};
+
+#include "Lab4_SortingNetworkKernels.inc"
+
+} // namespace avx2
+#pragma GCC pop_options
+
+#pragma GCC push_options
+#pragma GCC target("sse4.1")
+namespace sse4 {
+
+// Byte shuffle control that moves 32-bit or 64-bit lane perm[i] into lane i
+template <int Lanes>
+inline __m128i shuffleControl(const int* perm) {
+    const int width = 16 / Lanes;
+    auto byte = [&](int i) { return static_cast<char>(perm[i / width] * width + i % width); };
+    return _mm_setr_epi8(byte(0), byte(1), byte(2), byte(3), byte(4), byte(5), byte(6), byte(7),
+                         byte(8), byte(9), byte(10), byte(11), byte(12), byte(13), byte(14), byte(15));
+}
+
+// Mask that selects lane i when takeB[i] is set
+template <int Lanes>
+inline __m128i laneMask(const int* takeB) {
+    if constexpr (Lanes == 4) {
+        return _mm_setr_epi32(takeB[0], takeB[1], takeB[2], takeB[3]);
+    } else {
+        return _mm_setr_epi32(takeB[0], takeB[0], takeB[1], takeB[1]);
+    }
+}
+
+template <typename T> struct Ops;
+
+template <> struct Ops<int32_t> {
+    using Vec = __m128i;
+    static const int lanes = 4;
+    static Vec broadcast(int32_t x) { return _mm_set1_epi32(x); }
+    static Vec load(const int32_t* p) { return _mm_loadu_si128(reinterpret_cast<const __m128i*>(p)); }
+    static void store(int32_t* p, Vec v) { _mm_storeu_si128(reinterpret_cast<__m128i*>(p), v); }
+    static Vec min(Vec a, Vec b) { return _mm_min_epi32(a, b); }
+    static Vec max(Vec a, Vec b) { return _mm_max_epi32(a, b); }
+    static Vec permute(Vec v, const int* perm) { return _mm_shuffle_epi8(v, shuffleControl<lanes>(perm)); }
+    static Vec blend(Vec a, Vec b, const int* takeB) { return _mm_blendv_epi8(a, b, laneMask<lanes>(takeB)); }
+    static Vec reverse(Vec v) { return _mm_shuffle_epi32(v, 0x1B); }
+};
+
+template <> struct Ops<float> {
+    using Vec = __m128;
+    static const int lanes = 4;
+    static Vec broadcast(float x) { return _mm_set1_ps(x); }
+    static Vec load(const float* p) { return _mm_loadu_ps(p); }
+    static void store(float* p, Vec v) { _mm_storeu_ps(p, v); }
+    static Vec min(Vec a, Vec b) { return _mm_min_ps(a, b); }
+    static Vec max(Vec a, Vec b) { return _mm_max_ps(a, b); }
+    static Vec permute(Vec v, const int* perm) {
+        return _mm_castsi128_ps(_mm_shuffle_epi8(_mm_castps_si128(v), shuffleControl<lanes>(perm)));
+    }
+    static Vec blend(Vec a, Vec b, const int* takeB) { return _mm_blendv_ps(a, b, _mm_castsi128_ps(laneMask<lanes>(takeB))); }
+    static Vec reverse(Vec v) { return _mm_shuffle_ps(v, v, 0x1B); }
+};
+
+template <> struct Ops<double> {
+    using Vec = __m128d;
+    static const int lanes = 2;
+    static Vec broadcast(double x) { return _mm_set1_pd(x); }
+    static Vec load(const double* p) { return _mm_loadu_pd(p); }
+    static void store(double* p, Vec v) { _mm_storeu_pd(p, v); }
+    static Vec min(Vec a, Vec b) { return _mm_min_pd(a, b); }
+    static Vec max(Vec a, Vec b) { return _mm_max_pd(a, b); }
+    static Vec permute(Vec v, const int* perm) {
+        return _mm_castsi128_pd(_mm_shuffle_epi8(_mm_castpd_si128(v), shuffleControl<lanes>(perm)));
+    }
+    static Vec blend(Vec a, Vec b, const int* takeB) { return _mm_blendv_pd(a, b, _mm_castsi128_pd(laneMask<lanes>(takeB))); }
+    static Vec reverse(Vec v) { return _mm_shuffle_pd(v, v, 1); }
+};
+
+#include "Lab4_SortingNetworkKernels.inc"
+
+} // namespace sse4
+#pragma GCC pop_options
+
+// Best instruction set of this CPU, detected once at runtime
+inline SimdLevel simdLevel() {
+    static const SimdLevel level = __builtin_cpu_supports("avx512f") ? SimdLevel::Avx512
+                                 : __builtin_cpu_supports("avx2") ? SimdLevel::Avx2
+                                 : __builtin_cpu_supports("sse4.1") ? SimdLevel::Sse4
+                                 : SimdLevel::Scalar;
+    return level;
+}
+#else
+inline SimdLevel simdLevel() { return SimdLevel::Scalar; }
+#endif
+
+// Name of a SIMD level for reports
+inline const char* simdLevelName(SimdLevel level) {
+    switch (level) {
+        case SimdLevel::Avx512: return "AVX-512";
+        case SimdLevel::Avx2: return "AVX2";
+        case SimdLevel::Sse4: return "SSE4.1";
+        case SimdLevel::Scalar: return "scalar";
+    }
+    return "unknown";
+}
+
+// Key types with SIMD sorting network kernels
+template <typename T>
+constexpr bool hasNetworkSort = std::is_same<T, int32_t>::value || std::is_same<T, float>::value ||
+                                std::is_same<T, double>::value;
+
+// Whether `Compare` is plain ascending operator< on T (std::less<>, std::less<T> or
+// std::ranges::less), so key-specific engines may ignore the comparator
+template <typename Compare, typename T>
+constexpr bool plainOrder = std::is_same<Compare, std::less<>>::value || std::is_same<Compare, std::less<T>>::value ||
+                            std::is_same<Compare, std::ranges::less>::value;
+
+// Whether `Compare` is plain descending operator> on T (std::greater<>, std::greater<T> or
+// std::ranges::greater), the reverse of plainOrder
+template <typename Compare, typename T>
+constexpr bool plainReverseOrder = std::is_same<Compare, std::greater<>>::value ||
+                                   std::is_same<Compare, std::greater<T>>::value ||
+                                   std::is_same<Compare, std::ranges::greater>::value;
+
+// True when It points into contiguous int32/float/double keys in plain ascending order,
+// so the vector kernels may work on raw pointers instead of calling `comp`
+template <typename It, typename Compare>
+constexpr bool vectorizable = std::contiguous_iterator<It> && hasNetworkSort<std::iter_value_t<It>> &&
+                              plainOrder<Compare, std::iter_value_t<It>>;
+
+// Sort data[0..n), n <= networkMaxElements, with the best sorting network for this CPU.
+// NaNs are not supported.
+template <typename T>
+void networkSort(T* data, int n) {
+    static_assert(hasNetworkSort<T>, "Sorting networks exist for int32_t, float and double");
+    if (n < 2) return;
+#if (defined(__x86_64__) || defined(__i386__)) && defined(__GNUC__)
+    const T padding = std::numeric_limits<T>::has_infinity ? std::numeric_limits<T>::infinity()
+                                                            : std::numeric_limits<T>::max();
+    switch (simdLevel()) {
+        // The networks stop at AVX2: 64 keys fit in eight 256-bit registers
+        case SimdLevel::Avx512:
+        case SimdLevel::Avx2: avx2::sortBlock(data, n, padding); return;
+        case SimdLevel::Sse4: sse4::sortBlock(data, n, padding); return;
+        case SimdLevel::Scalar: break;
+    }
+#endif
+    for (int i = 1; i < n; ++i) {
+        T key = data[i];
+        int j = i - 1;
+        while (j >= 0 && data[j] > key) {
+            data[j + 1] = data[j];
+            --j;
+        }
+        data[j + 1] = key;
+    }
+}
+
+// Base case for the hybrid sorts: a sorting network for small int32/float/double
+// ranges, Insertion Sort for everything else
+template <typename It, typename Compare = std::less<>>
+void smallSort(It first, It last, Compare comp = {}) {
+    if constexpr (vectorizable<It, Compare>) {
+        if (last - first <= networkMaxElements) {
+            networkSort(std::to_address(first), static_cast<int>(last - first));
+            return;
+        }
+    }
+    insertionSort(first, last, comp);
+}
+
+// smallSort of arr[left..right]
+template <typename T>
+void smallSort(std::vector<T>& arr, int left, int right) {
+    if (left >= right) return;
+    smallSort(arr.begin() + left, arr.begin() + right + 1);
+}
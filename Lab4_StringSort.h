@@ -0,0 +1,338 @@
+#pragma once
+
+#include <algorithm>
+#include <cstdint>
+#include <functional>
+#include <iterator>
+#include <random>
+#include <string>
+#include <string_view>
+#include <type_traits>
+#include <utility>
+#include <vector>
+#include "Lab4_IndexSort.h"
+#include "Lab4_Parallel.h"
+#include "Lab4_RadixSort.h"
+
+// The engines below sort elements by the string `proj(element)`, which must be a reference
+// to (or a view of) a string stored in the element, e.g. std::identity for std::string or
+// &Record::name. Elements are only ever moved; the strings are read through views.
+
+// Ranges up to this size finish with an insertion sort on the unsorted suffixes
+const int stringInsertionThreshold = 16;
+
+// The string `proj` projects x to
+template <typename Proj, typename T>
+std::string_view stringKey(const Proj& proj, const T& x) {
+    static_assert(!std::is_same<std::invoke_result_t<const Proj&, const T&>, std::string>::value,
+                  "The projection must return a reference to a string, not a temporary copy");
+    return std::string_view(std::invoke(proj, x));
+}
+
+// The characters of s from `depth` on
+inline std::string_view suffix(std::string_view s, size_t depth) {
+    return s.substr(std::min(depth, s.size()));
+}
+
+// Character `depth` of s as 0..255, or -1 past the end, so shorter strings sort first
+inline int charAt(std::string_view s, size_t depth) {
+    return depth < s.size() ? static_cast<unsigned char>(s[depth]) : -1;
+}
+
+// Insertion Sort of [first, last) whose strings all share their first `depth` characters;
+// only the suffixes from `depth` on are compared
+template <typename It, typename Proj = std::identity>
+void suffixInsertionSort(It first, It last, size_t depth, Proj proj = {}) {
+    if (first == last) return;
+    for (It i = first + 1; i != last; ++i) {
+        auto value = std::move(*i);
+        std::string_view key = suffix(stringKey(proj, value), depth);
+        It j = i;
+        while (j != first && suffix(stringKey(proj, *(j - 1)), depth) > key) {
+            *j = std::move(*(j - 1));
+            --j;
+        }
+        *j = std::move(value);
+    }
+}
+
+// Multikey Quick Sort (Bentley and Sedgewick) of [first, last), whose strings share
+// their first `depth` characters. A three-way partition on the character at `depth`
+// splits off the smaller and larger characters; the equal part moves on to the next
+// character, so shared prefixes are scanned only once.
+template <typename It, typename Proj = std::identity>
+    requires std::random_access_iterator<It>
+void multikeyQuickSort(It first, It last, size_t depth = 0, Proj proj = {}) {
+    auto at = [&proj, &depth](It it) { return charAt(stringKey(proj, *it), depth); };
+    while (last - first > stringInsertionThreshold) {
+        // Median of three characters as the pivot
+        int a = at(first);
+        int b = at(first + (last - first) / 2);
+        int c = at(last - 1);
+        int pivot = std::max(std::min(a, b), std::min(std::max(a, b), c));
+
+        It lt = first, gt = last, i = first;
+        while (i < gt) {
+            int ch = at(i);
+            if (ch < pivot) {
+                std::iter_swap(lt++, i++);
+            } else if (ch > pivot) {
+                std::iter_swap(i, --gt);
+            } else {
+                ++i;
+            }
+        }
+        multikeyQuickSort(first, lt, depth, proj);
+        multikeyQuickSort(gt, last, depth, proj);
+        // Strings that ended at `depth` are all equal
+        if (pivot < 0) return;
+        first = lt;
+        last = gt;
+        ++depth;
+    }
+    suffixInsertionSort(first, last, depth, proj);
+}
+
+// Multikey Quick Sort of arr[low..high]
+inline void multikeyQuickSort(std::vector<std::string>& arr, int low, int high, size_t depth = 0) {
+    if (low >= high) return;
+    multikeyQuickSort(arr.begin() + low, arr.begin() + high + 1, depth);
+}
+
+// Big-endian 8 bytes of s starting at `depth`, zero-padded
+inline uint64_t prefixAt(std::string_view s, size_t depth) {
+    uint64_t prefix = 0;
+    for (size_t i = depth; i < depth + 8; ++i) {
+        prefix = (prefix << 8) | (i < s.size() ? static_cast<unsigned char>(s[i]) : 0u);
+    }
+    return prefix;
+}
+
+// Sort entries[begin..end) of the elements at `first`, whose strings agree on their first
+// `depth` bytes: cache the next 8 bytes of every string in its entry, MSD radix sort the
+// entries on that prefix and refine each run of equal prefixes 8 bytes deeper. Strings
+// are never touched except to load the prefixes.
+template <typename It, typename Proj>
+void cachedPrefixSort(It first, std::vector<PrefixIndex>& entries, size_t begin, size_t end, size_t depth,
+                      const Proj& proj) {
+    for (size_t i = begin; i < end; ++i) {
+        entries[i].prefix = prefixAt(stringKey(proj, first[entries[i].index]), depth);
+    }
+    americanFlagSort(entries.begin() + begin, entries.begin() + end, 64 - radixBits);
+
+    auto length = [&](const PrefixIndex& entry) { return stringKey(proj, first[entry.index]).size(); };
+    for (size_t start = begin; start < end;) {
+        size_t stop = start + 1;
+        while (stop < end && entries[stop].prefix == entries[start].prefix) ++stop;
+        if (stop - start > 1) {
+            bool longer = false;
+            for (size_t i = start; i < stop; ++i) longer |= length(entries[i]) > depth + 8;
+            if (longer) {
+                cachedPrefixSort(first, entries, start, stop, depth + 8, proj);
+            } else {
+                // Within 8 bytes an equal prefix can only differ by trailing zero bytes
+                std::sort(entries.begin() + start, entries.begin() + stop,
+                          [&length](const PrefixIndex& a, const PrefixIndex& b) { return length(a) < length(b); });
+            }
+        }
+        start = stop;
+    }
+}
+
+// MSD Radix Sort of [first, last) on an array of cached 8-byte prefixes; every element
+// is moved once at the end by following the permutation cycles
+template <typename It, typename Proj = std::identity>
+    requires std::random_access_iterator<It>
+void cachedPrefixRadixSort(It first, It last, Proj proj = {}) {
+    size_t n = last - first;
+    if (n < 2) return;
+    std::vector<PrefixIndex> entries(n);
+    for (size_t i = 0; i < n; ++i) entries[i].index = i;
+    cachedPrefixSort(first, entries, 0, n, 0, proj);
+
+    std::vector<size_t> perm(n);
+    for (size_t i = 0; i < n; ++i) perm[i] = entries[i].index;
+    applyPermutation(first, perm);
+}
+
+// Cached-prefix MSD Radix Sort of arr[low..high]
+inline void cachedPrefixRadixSort(std::vector<std::string>& arr, int low, int high) {
+    if (low >= high) return;
+    cachedPrefixRadixSort(arr.begin() + low, arr.begin() + high + 1);
+}
+
+// Length of the common prefix of a and b, starting the scan at `from`
+inline size_t commonPrefix(std::string_view a, std::string_view b, size_t from) {
+    size_t n = std::min(a.size(), b.size());
+    size_t i = from;
+    while (i < n && a[i] == b[i]) ++i;
+    return i;
+}
+
+// LCP-aware merge of the sorted runs src[left..mid) and src[mid..right) into dst.
+// lcp[i] holds the common prefix length of element i and its predecessor in the same run.
+// A run head whose LCP with the last output is larger than the other head's is smaller,
+// so most steps decide without touching a character; ties compare from the shared LCP on.
+template <typename In, typename Out, typename Proj>
+void lcpMerge(In src, const std::vector<size_t>& srcLcp, Out dst, std::vector<size_t>& dstLcp,
+              size_t left, size_t mid, size_t right, const Proj& proj) {
+    size_t i = left, j = mid, k = left;
+    // LCP of each head with the last element written to dst
+    size_t lcpA = 0, lcpB = 0;
+    while (i < mid && j < right) {
+        bool takeA;
+        if (lcpA > lcpB) {
+            takeA = true;
+        } else if (lcpA < lcpB) {
+            takeA = false;
+        } else {
+            std::string_view a = stringKey(proj, src[i]), b = stringKey(proj, src[j]);
+            size_t h = commonPrefix(a, b, lcpA);
+            takeA = !(suffix(b, h) < suffix(a, h));
+            // The other head now shares h characters with the element written
+            if (takeA) lcpB = h;
+            else lcpA = h;
+        }
+        if (takeA) {
+            dstLcp[k] = lcpA;
+            dst[k++] = std::move(src[i++]);
+            if (i < mid) lcpA = srcLcp[i];
+        } else {
+            dstLcp[k] = lcpB;
+            dst[k++] = std::move(src[j++]);
+            if (j < right) lcpB = srcLcp[j];
+        }
+    }
+    while (i < mid) {
+        dstLcp[k] = lcpA;
+        dst[k++] = std::move(src[i++]);
+        if (i < mid) lcpA = srcLcp[i];
+    }
+    while (j < right) {
+        dstLcp[k] = lcpB;
+        dst[k++] = std::move(src[j++]);
+        if (j < right) lcpB = srcLcp[j];
+    }
+}
+
+// Sort arr[left..right) and fill lcp[left..right); runs are merged into the scratch
+// arrays and moved back, so elements are only ever moved, never copied
+template <typename It, typename Buf, typename Proj>
+void lcpMergeSortRange(It arr, std::vector<size_t>& lcp, Buf buffer, std::vector<size_t>& bufferLcp,
+                       size_t left, size_t right, const Proj& proj) {
+    if (right - left <= static_cast<size_t>(stringInsertionThreshold)) {
+        suffixInsertionSort(arr + left, arr + right, 0, proj);
+        lcp[left] = 0;
+        for (size_t i = left + 1; i < right; ++i) {
+            lcp[i] = commonPrefix(stringKey(proj, arr[i - 1]), stringKey(proj, arr[i]), 0);
+        }
+        return;
+    }
+    size_t mid = left + (right - left) / 2;
+    lcpMergeSortRange(arr, lcp, buffer, bufferLcp, left, mid, proj);
+    lcpMergeSortRange(arr, lcp, buffer, bufferLcp, mid, right, proj);
+    lcpMerge(arr, lcp, buffer, bufferLcp, left, mid, right, proj);
+    std::move(buffer + left, buffer + right, arr + left);
+    std::copy(bufferLcp.begin() + left, bufferLcp.begin() + right, lcp.begin() + left);
+}
+
+// LCP Merge Sort of [first, last): a merge sort that carries the longest common
+// prefix of neighbouring strings, so merging never re-scans a shared prefix. Stable.
+template <typename It, typename Proj = std::identity>
+    requires std::random_access_iterator<It>
+void lcpMergeSort(It first, It last, Proj proj = {}) {
+    size_t n = last - first;
+    if (n < 2) return;
+    std::vector<std::iter_value_t<It>> buffer(n);
+    std::vector<size_t> lcp(n), bufferLcp(n);
+    lcpMergeSortRange(first, lcp, buffer.begin(), bufferLcp, 0, n, proj);
+}
+
+// LCP Merge Sort of arr[left..right]
+inline void lcpMergeSort(std::vector<std::string>& arr, int left, int right) {
+    if (left >= right) return;
+    lcpMergeSort(arr.begin() + left, arr.begin() + right + 1);
+}
+
+// Parallel String Sample Sort of [first, last). A sorted random sample gives one
+// splitter per bucket; every task classifies one slice of the input by binary search,
+// the elements are moved into their buckets, and the buckets are sorted in parallel
+// with Multikey Quick Sort. The sample positions come from a generator seeded with n,
+// so runs are repeatable and a period in the input cannot alias with the sample the
+// way it can with evenly spaced positions.
+template <typename It, typename Proj = std::identity>
+void parallelStringSampleSort(It first, It last, ThreadPool& pool, Proj proj = {}, size_t cutoff = 1 << 12) {
+    size_t n = last - first;
+    if (n <= cutoff || pool.threadCount() == 1) {
+        multikeyQuickSort(first, last, 0, proj);
+        return;
+    }
+    // 8 buckets per thread, oversampled 16 times
+    size_t buckets = std::min<size_t>(pool.threadCount() * 8, n / cutoff + 1);
+    size_t oversampling = 16;
+    std::vector<std::string> sample;
+    std::minstd_rand gen(static_cast<unsigned>(n));
+    std::uniform_int_distribution<size_t> position(0, n - 1);
+    for (size_t s = 0; s < buckets * oversampling; ++s) {
+        sample.emplace_back(stringKey(proj, first[position(gen)]));
+    }
+    multikeyQuickSort(sample.begin(), sample.end());
+    std::vector<std::string> splitters;
+    for (size_t b = 1; b < buckets; ++b) splitters.push_back(sample[b * oversampling]);
+
+    // Classify slices in parallel: bucket of every element and per-slice bucket counts
+    size_t slices = pool.threadCount();
+    std::vector<size_t> bucketOf(n);
+    std::vector<std::vector<size_t>> counts(slices, std::vector<size_t>(buckets, 0));
+    TaskGroup group(pool);
+    for (size_t s = 0; s < slices; ++s) {
+        group.run([&, s]() {
+            auto below = [](std::string_view key, const std::string& splitter) { return key < splitter; };
+            for (size_t i = s * n / slices; i < (s + 1) * n / slices; ++i) {
+                size_t b = std::upper_bound(splitters.begin(), splitters.end(), stringKey(proj, first[i]), below) -
+                           splitters.begin();
+                bucketOf[i] = b;
+                ++counts[s][b];
+            }
+        });
+    }
+    group.wait();
+
+    // Exclusive prefix sums in bucket-major order give every slice its write positions
+    std::vector<size_t> bucketStart(buckets + 1, 0);
+    size_t offset = 0;
+    for (size_t b = 0; b < buckets; ++b) {
+        bucketStart[b] = offset;
+        for (size_t s = 0; s < slices; ++s) {
+            size_t c = counts[s][b];
+            counts[s][b] = offset;
+            offset += c;
+        }
+    }
+    bucketStart[buckets] = n;
+
+    std::vector<std::iter_value_t<It>> buffer(n);
+    for (size_t s = 0; s < slices; ++s) {
+        group.run([&, s]() {
+            for (size_t i = s * n / slices; i < (s + 1) * n / slices; ++i) {
+                buffer[counts[s][bucketOf[i]]++] = std::move(first[i]);
+            }
+        });
+    }
+    group.wait();
+
+    for (size_t b = 0; b < buckets; ++b) {
+        group.run([&, b]() {
+            multikeyQuickSort(buffer.begin() + bucketStart[b], buffer.begin() + bucketStart[b + 1], 0, proj);
+            std::move(buffer.begin() + bucketStart[b], buffer.begin() + bucketStart[b + 1], first + bucketStart[b]);
+        });
+    }
+    group.wait();
+}
+
+// Parallel String Sample Sort of arr[low..high]
+inline void parallelStringSampleSort(std::vector<std::string>& arr, int low, int high, ThreadPool& pool,
+                                     int cutoff = 1 << 12) {
+    if (low >= high) return;
+    parallelStringSampleSort(arr.begin() + low, arr.begin() + high + 1, pool, std::identity(), cutoff);
+}
@@ -0,0 +1,120 @@
+#pragma once
+
+#include <fstream>
+#include <iostream>
+#include <map>
+#include <sstream>
+#include <string>
+#include <type_traits>
+#include <vector>
+#include "Lab4_Benchmark.h"
+#include "Lab4_Generators.h"
+
+// Cutoff the hybrid sorts use when the profile has no entry for them
+const int defaultHybridThreshold = 10;
+
+// Small-array cutoffs tried by a calibration sweep
+inline const std::vector<int>& thresholdCandidates() {
+    static const std::vector<int> candidates = {4, 6, 8, 12, 16, 24, 32, 48, 64, 96, 128};
+    return candidates;
+}
+
+// Name of a key type in threshold profiles
+template <typename T>
+std::string typeKey() {
+    if constexpr (std::is_same<T, int>::value) return "int";
+    else if constexpr (std::is_same<T, double>::value) return "double";
+    else if constexpr (std::is_same<T, std::string>::value) return "string";
+    else return "other";
+}
+
+// Small-array cutoffs keyed by "<algorithm> <type>", e.g. "merge-hybrid int"
+using ThresholdProfile = std::map<std::string, int>;
+
+// The profile the hybrid sorts read; empty until a profile is loaded or calibrated
+inline ThresholdProfile& thresholdProfile() {
+    static ThresholdProfile profile;
+    return profile;
+}
+
+// Load a profile of "<algorithm> <type> <threshold>" lines; '#' starts a comment.
+// Returns false, leaving the profile unchanged, when the file cannot be read.
+inline bool loadThresholdProfile(const std::string& path) {
+    std::ifstream in(path);
+    if (!in) return false;
+    std::string line;
+    while (std::getline(in, line)) {
+        if (line.empty() || line[0] == '#') continue;
+        std::istringstream fields(line);
+        std::string algorithm, type;
+        int threshold;
+        if (fields >> algorithm >> type >> threshold && threshold > 0) {
+            thresholdProfile()[algorithm + " " + type] = threshold;
+        }
+    }
+    return true;
+}
+
+// Write the current profile in the format loadThresholdProfile reads
+inline bool saveThresholdProfile(const std::string& path) {
+    std::ofstream out(path);
+    if (!out) {
+        std::cerr << "Cannot open " << path << " for writing" << std::endl;
+        return false;
+    }
+    out << "# Small-array cutoffs of the hybrid sorts, written by --calibrate\n";
+    out << "# algorithm type threshold\n";
+    for (const auto& [key, threshold] : thresholdProfile()) {
+        out << key << ' ' << threshold << '\n';
+    }
+    return true;
+}
+
+// Cutoff for `algorithm` on keys of type T: the profile entry, or defaultHybridThreshold
+template <typename T>
+int tunedThreshold(const std::string& algorithm) {
+    auto it = thresholdProfile().find(algorithm + " " + typeKey<T>());
+    return it != thresholdProfile().end() ? it->second : defaultHybridThreshold;
+}
+
+// Uniform random keys of type T for a calibration sweep; strings are 5 random letters
+template <typename T>
+std::vector<T> calibrationInput(int size) {
+    auto keys = generateList(Distribution::Uniform, size, 0, 1000000000);
+    std::vector<T> input;
+    input.reserve(size);
+    for (int key : keys) {
+        if constexpr (std::is_same<T, std::string>::value) {
+            std::string word;
+            for (int i = 0; i < 5; ++i, key /= 26) word += static_cast<char>('a' + key % 26);
+            input.push_back(word);
+        } else {
+            input.push_back(static_cast<T>(key));
+        }
+    }
+    return input;
+}
+
+// Time `sort(arr, threshold)` on random keys for every candidate threshold and store the
+// fastest in the profile under `algorithm` and T. Returns the chosen threshold.
+template <typename T, typename Sort>
+int calibrateThreshold(const std::string& algorithm, Sort sort, int size = 1 << 14) {
+    BenchmarkConfig sweep;
+    sweep.warmup = 1;
+    sweep.repetitions = 5;
+    auto input = calibrationInput<T>(size);
+
+    int best = defaultHybridThreshold;
+    double bestTime = 0.0;
+    for (int threshold : thresholdCandidates()) {
+        BenchmarkResult result = runBenchmark(algorithm, [&](std::vector<T>& arr) { sort(arr, threshold); }, input, sweep);
+        if (bestTime == 0.0 || result.median < bestTime) {
+            best = threshold;
+            bestTime = result.median;
+        }
+    }
+    thresholdProfile()[algorithm + " " + typeKey<T>()] = best;
+    std::cout << "Calibrated " << algorithm << " for " << typeKey<T>() << ": threshold " << best
+              << " (" << bestTime << " seconds for " << size << " keys)" << std::endl;
+    return best;
+}